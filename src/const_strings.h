@@ -21,6 +21,52 @@ namespace keywords {
 		static constexpr std::string_view hVar_approach{ "hVar-approach" };
 	}
 
+	namespace solvers {
+		static constexpr std::string_view solver{ "solver" };
+
+		static constexpr std::string_view dependency_order{ "dependency-order" };
+		static constexpr std::string_view hybrid{ "hybrid" };
+		static constexpr std::string_view multi_modular{ "multi-modular" };
+		static constexpr std::string_view incremental{ "incremental" };
+		static constexpr std::string_view automatic{ "automatic" };
+
+		static constexpr std::string_view selection{ "solver-selection" }; // json object with thresholds for automatic, see solver_selection_thresholds
+
+		static constexpr std::string_view min_scc_for_modular{ "min-scc-for-modular" };
+		static constexpr std::string_view min_solution_bits_for_modular{ "min-solution-bits-for-modular" };
+		static constexpr std::string_view max_solution_bits_for_hybrid{ "max-solution-bits-for-hybrid" };
+
+		static constexpr std::string_view ordering{ "ordering" };
+
+		static constexpr std::string_view discovery{ "discovery" };
+		static constexpr std::string_view scc_topological{ "scc-topological" };
+		static constexpr std::string_view minimum_degree{ "minimum-degree" };
+
+		static constexpr std::string_view statistics{ "statistics" };
+	}
+
+	namespace policy_iteration {
+		static constexpr std::string_view evaluation{ "evaluation" };
+
+		static constexpr std::string_view exact{ "exact" };
+		static constexpr std::string_view sweeps{ "sweeps" }; // also the key for the number of sweeps per round
+		static constexpr std::string_view floating_point{ "floating-point" };
+
+		static constexpr std::string_view initial_scheduler{ "initial-scheduler" }; // json object state -> action, or the name of a file containing it
+		static constexpr std::string_view reuse_previous_scheduler{ "reuse-previous-scheduler" };
+
+		static constexpr std::string_view action_elimination{ "action-elimination" };
+	}
+
+	namespace algorithms {
+		static constexpr std::string_view algorithm{ "algorithm" };
+
+		static constexpr std::string_view policy_iteration{ "policy-iteration" };
+		static constexpr std::string_view interval_iteration{ "interval-iteration" };
+
+		static constexpr std::string_view precision{ "precision" };
+	}
+
 	namespace checks {
 		static constexpr std::string_view checks{ "checks" };
 
@@ -40,7 +40,10 @@ rational_type string_to_rational_type(const std::string& s) { // do-check!
 			return string_to_rational_type(s.substr(0, s.size() - 1 - (iter - copy.rbegin()))) * string_to_rational_type(s.substr(s.size() - (iter - copy.rbegin())));
 		}
 		if (*iter == '/') {
-			return string_to_rational_type(s.substr(0, s.size() - 1 - (iter - copy.rbegin()))) / string_to_rational_type(s.substr(s.size() - (iter - copy.rbegin())));
+			const rational_type divisor{ string_to_rational_type(s.substr(s.size() - (iter - copy.rbegin()))) };
+			if (divisor == rational_type(0))
+				throw rational_parse_error(std::string("Division by zero in \"") + s + "\"");
+			return string_to_rational_type(s.substr(0, s.size() - 1 - (iter - copy.rbegin()))) / divisor;
 		}
 	}
 	rational_type::int_type value;
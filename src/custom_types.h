@@ -4,6 +4,7 @@
 #include <boost/multiprecision/cpp_int.hpp>
 #include <boost/rational.hpp>
 
+#include <atomic>
 #include <set>
 #include <map>
 
@@ -50,6 +51,21 @@ public:
 	}
 };
 
+/*
+	thrown by an analysis that was asked to stop, because its result is not needed anymore
+*/
+class analysis_cancelled : public std::runtime_error {
+
+public:
+
+	template <class T>
+	analysis_cancelled(const T& arg) : std::runtime_error(arg) {}
+
+	static void check(const std::atomic<bool>* cancelled) {
+		if (cancelled != nullptr && cancelled->load(std::memory_order_relaxed)) throw analysis_cancelled("Analysis cancelled.");
+	}
+};
+
 class found_unreachable_state : public std::logic_error {
 public:
 	template <class T>
@@ -0,0 +1,304 @@
+#pragma once
+
+#include "mdp_ops.h"
+#include "qualitative_reachability.h"
+#include "variable_ordering.h"
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+/*
+	Maximal end components (MECs): sets of states with a choice of actions such that the chosen actions never leave the set
+	and every state of the set can reach every other one.
+	An end component using only actions of reward 0 lets a scheduler loop without any reward and without ever reaching a target,
+	such a scheduler makes (I - P_sched) singular. Collapsing every such component into one state that only keeps the actions leaving
+	the component removes these improper schedulers without changing the values of the proper ones.
+	This only holds for the expected total reward (classic mode): the representative has one choice where the members could choose different exits,
+	so schedulers that depend on more than the state, like the ones of the unfolded modes, are lost.
+*/
+
+/*
+	The classical algorithm: strongly connected components of the allowed actions, then remove actions leaving their component
+	and states without remaining actions, repeat until nothing changes.
+	@param allowed per action of graph whether it may be part of an end component
+	@param in_end_component is set per action of graph whether it belongs to the returned end components
+	@return the maximal end components, each ascending
+*/
+inline std::vector<linear_systems::id_vector> maximal_end_components(const qualitative_graph& graph, const std::vector<bool>& allowed, std::vector<bool>& in_end_component) {
+	constexpr std::size_t NONE{ std::numeric_limits<std::size_t>::max() };
+	in_end_component = allowed;
+	std::vector<bool> alive(graph.count_states(), true);
+	std::vector<std::size_t> component_of(graph.count_states(), NONE);
+
+	while (true) {
+		std::vector<linear_systems::id_vector> successors(graph.count_states());
+		linear_systems::id_vector alive_states;
+		for (linear_systems::var_id state{ 0 }; state < graph.count_states(); ++state) {
+			if (!alive[state]) {
+				continue;
+			}
+			alive_states.push_back(state);
+			for (std::size_t a{ graph.actions_begin(state) }; a < graph.actions_end(state); ++a) {
+				if (in_end_component[a]) {
+					for (std::size_t t{ graph.transitions_begin(a) }; t < graph.transitions_end(a); ++t) {
+						successors[state].push_back(graph.successor(t));
+					}
+				}
+			}
+		}
+		auto components{ linear_systems::strongly_connected_components(successors, alive_states) };
+		std::fill(component_of.begin(), component_of.end(), NONE);
+		for (std::size_t c{ 0 }; c < components.size(); ++c) {
+			for (const auto& state : components[c]) {
+				component_of[state] = c;
+			}
+		}
+
+		bool changed{ false };
+		for (const auto& state : alive_states) {
+			bool has_action{ false };
+			for (std::size_t a{ graph.actions_begin(state) }; a < graph.actions_end(state); ++a) {
+				if (!in_end_component[a]) {
+					continue;
+				}
+				for (std::size_t t{ graph.transitions_begin(a) }; t < graph.transitions_end(a); ++t) {
+					if (component_of[graph.successor(t)] != component_of[state]) {
+						in_end_component[a] = false;
+						changed = true;
+						break;
+					}
+				}
+				has_action = has_action || in_end_component[a];
+			}
+			if (!has_action) {
+				alive[state] = false;
+				changed = true;
+			}
+		}
+		if (!changed) {
+			for (auto& component : components) {
+				std::sort(component.begin(), component.end());
+			}
+			return components;
+		}
+	}
+}
+
+/*
+	representative state -> states collapsed into it (including the representative), ascending
+*/
+using end_component_mapping = std::map<std::string, std::vector<std::string>>;
+
+/*
+	What collapse_zero_reward_end_components did, for reporting results on the original states.
+*/
+struct collapsed_end_components {
+	mdp original; // before collapsing, only set if components is not empty
+	end_component_mapping components;
+};
+
+/*
+	Collapses every maximal end component of the actions with reward 0 (without targets) into its smallest state, the representative.
+	The representative gets the actions of all members that do not belong to the end component,
+	the ones of other members named "action@member". Transitions into members are redirected to the representative.
+	End components without any transition leaving them are traps that cannot reach a target, they are left unchanged.
+	@return the collapsed components
+*/
+inline collapsed_end_components collapse_zero_reward_end_components(mdp& m) {
+	const std::vector<std::string> names(m.states.cbegin(), m.states.cend());
+	const qualitative_graph graph{ make_qualitative_graph(m) };
+	const std::vector<bool> targets{ target_flags(m) };
+
+	// names and rewards of the actions of graph, in the same order as make_qualitative_graph:
+	std::vector<const std::string*> action_names;
+	std::vector<bool> allowed;
+	for (linear_systems::var_id state{ 0 }; state < graph.count_states(); ++state) {
+		const auto found{ m.probabilities.find(names[state]) };
+		if (found == m.probabilities.cend()) {
+			continue;
+		}
+		for (const auto& action_paired_distr : found->second) {
+			action_names.push_back(&action_paired_distr.first);
+			allowed.push_back(!targets[state] && m.rewards.at(names[state]).at(action_paired_distr.first) == rational_type(0));
+		}
+	}
+
+	std::vector<bool> in_end_component;
+	const auto components{ maximal_end_components(graph, allowed, in_end_component) };
+
+	collapsed_end_components result;
+	std::map<std::string, std::string> representative_of; // member -> representative, only for collapsed components
+	std::vector<bool> is_member(graph.count_states(), false);
+	for (const auto& component : components) {
+		for (const auto& state : component) {
+			is_member[state] = true;
+		}
+		bool has_exit{ false };
+		for (const auto& state : component) {
+			for (std::size_t a{ graph.actions_begin(state) }; a < graph.actions_end(state); ++a) {
+				for (std::size_t t{ graph.transitions_begin(a) }; t < graph.transitions_end(a); ++t) {
+					has_exit = has_exit || !is_member[graph.successor(t)];
+				}
+			}
+		}
+		for (const auto& state : component) {
+			is_member[state] = false;
+		}
+		if (!has_exit) {
+			continue;
+		}
+		auto& members{ result.components[names[component.front()]] };
+		for (const auto& state : component) {
+			members.push_back(names[state]);
+			representative_of.emplace(names[state], names[component.front()]);
+		}
+	}
+	if (result.components.empty()) {
+		return result;
+	}
+	result.original = m;
+
+	const auto redirect = [&](const std::map<std::string, rational_type>& distr, std::map<std::string, rational_type>& redirected) {
+		for (const auto& next_state_paired_probability : distr) {
+			const auto found{ representative_of.find(next_state_paired_probability.first) };
+			redirected[found == representative_of.cend() ? next_state_paired_probability.first : found->second] += next_state_paired_probability.second;
+		}
+	};
+
+	// the actions of the representatives:
+	std::map<std::string, std::map<std::string, std::map<std::string, rational_type>>> collapsed_probabilities;
+	std::map<std::string, std::map<std::string, rational_type>> collapsed_rewards;
+	for (linear_systems::var_id state{ 0 }; state < graph.count_states(); ++state) {
+		const auto found{ representative_of.find(names[state]) };
+		if (found == representative_of.cend()) {
+			continue;
+		}
+		auto& probabilities{ collapsed_probabilities[found->second] };
+		auto& rewards{ collapsed_rewards[found->second] };
+		for (std::size_t a{ graph.actions_begin(state) }; a < graph.actions_end(state); ++a) {
+			if (in_end_component[a]) {
+				continue;
+			}
+			const std::string action{ found->second == names[state] ? *action_names[a] : *action_names[a] + "@" + names[state] };
+			redirect(m.probabilities.at(names[state]).at(*action_names[a]), probabilities[action]);
+			rewards[action] = m.rewards.at(names[state]).at(*action_names[a]);
+			m.actions.insert(action);
+		}
+	}
+
+	// redirect all other transitions and replace the members:
+	for (auto& state_paired_actions : m.probabilities) {
+		if (representative_of.count(state_paired_actions.first)) {
+			continue;
+		}
+		for (auto& action_paired_distr : state_paired_actions.second) {
+			std::map<std::string, rational_type> redirected;
+			redirect(action_paired_distr.second, redirected);
+			action_paired_distr.second = std::move(redirected);
+		}
+	}
+	for (const auto& member_paired_representative : representative_of) {
+		if (member_paired_representative.first != member_paired_representative.second) {
+			m.states.erase(member_paired_representative.first);
+			m.probabilities.erase(member_paired_representative.first);
+			m.rewards.erase(member_paired_representative.first);
+		}
+	}
+	for (auto& representative_paired_probabilities : collapsed_probabilities) {
+		m.probabilities[representative_paired_probabilities.first] = std::move(representative_paired_probabilities.second);
+		m.rewards[representative_paired_probabilities.first] = std::move(collapsed_rewards[representative_paired_probabilities.first]);
+	}
+	if (const auto found{ representative_of.find(m.initial) }; found != representative_of.cend()) {
+		m.initial = found->second;
+	}
+	return result;
+}
+
+/*
+	@return representative of every state of a collapsed end component, the representatives included
+*/
+inline std::map<std::string, std::string> representatives(const end_component_mapping& components) {
+	std::map<std::string, std::string> result;
+	for (const auto& representative_paired_members : components) {
+		for (const auto& member : representative_paired_members.second) {
+			result.emplace(member, representative_paired_members.first);
+		}
+	}
+	return result;
+}
+
+/*
+	Maps optimal actions of the collapsed mdp back onto the states of collapsed.original.
+	A member gets its own actions whose collapsed counterpart is optimal (see collapse_zero_reward_end_components for the names).
+	A member without such an exit gets the actions of reward 0 staying in the component that reach a member closer to an optimal exit with positive probability,
+	so every combination of the listed actions leaves the component with probability 1 through an optimal exit.
+	@param optimal state of the collapsed mdp -> names of its optimal actions
+	@return the same for the original states, states outside the components are copied
+*/
+inline std::map<std::string, std::vector<std::string>> expand_optimal_actions(const collapsed_end_components& collapsed, const std::map<std::string, std::vector<std::string>>& optimal) {
+	constexpr std::size_t NONE{ std::numeric_limits<std::size_t>::max() };
+	std::map<std::string, std::vector<std::string>> result{ optimal };
+	for (const auto& [representative, members] : collapsed.components) {
+		const auto found{ optimal.find(representative) };
+		const std::vector<std::string> no_actions;
+		const std::vector<std::string>& optimal_at_representative{ found == optimal.cend() ? no_actions : found->second };
+		result.erase(representative);
+
+		std::map<std::string, std::size_t> distance; // to an optimal exit, in steps inside the component
+		for (const auto& member : members) {
+			distance[member] = NONE;
+			for (const auto& action_paired_distr : collapsed.original.probabilities.at(member)) {
+				const std::string name{ member == representative ? action_paired_distr.first : action_paired_distr.first + "@" + member };
+				if (std::find(optimal_at_representative.cbegin(), optimal_at_representative.cend(), name) != optimal_at_representative.cend()) {
+					result[member].push_back(action_paired_distr.first);
+					distance[member] = 0;
+				}
+			}
+		}
+		const auto stays_inside = [&](const std::string& member, const std::string& action) {
+			if (collapsed.original.rewards.at(member).at(action) != rational_type(0)) {
+				return false;
+			}
+			for (const auto& next_state_paired_probability : collapsed.original.probabilities.at(member).at(action)) {
+				if (!distance.count(next_state_paired_probability.first)) {
+					return false;
+				}
+			}
+			return true;
+		};
+		const auto gets_closer = [&](const std::string& member, const std::string& action, std::size_t bound) {
+			for (const auto& next_state_paired_probability : collapsed.original.probabilities.at(member).at(action)) {
+				if (next_state_paired_probability.second != rational_type(0) && distance.at(next_state_paired_probability.first) < bound) {
+					return true;
+				}
+			}
+			return false;
+		};
+		for (std::size_t round{ 1 }; round < members.size(); ++round) {
+			std::vector<std::string> reached;
+			for (const auto& member : members) {
+				if (distance.at(member) != NONE) {
+					continue;
+				}
+				for (const auto& action_paired_distr : collapsed.original.probabilities.at(member)) {
+					if (stays_inside(member, action_paired_distr.first) && gets_closer(member, action_paired_distr.first, round)) {
+						reached.push_back(member);
+						break;
+					}
+				}
+			}
+			for (const auto& member : reached) {
+				distance.at(member) = round;
+				for (const auto& action_paired_distr : collapsed.original.probabilities.at(member)) {
+					if (stays_inside(member, action_paired_distr.first) && gets_closer(member, action_paired_distr.first, round)) {
+						result[member].push_back(action_paired_distr.first);
+					}
+				}
+			}
+		}
+	}
+	return result;
+}
@@ -4,4 +4,5 @@
 namespace feature_toggle {
 	static constexpr bool RUN_ON_ZERO_ARGUMENTS{ true };
 	static constexpr uint64_t COUNT_THREADS{ 2000 };
+	static constexpr bool COLLAPSE_ZERO_REWARD_END_COMPONENTS{ true }; // classic mode only, see end_components.h
 }
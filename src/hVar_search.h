@@ -0,0 +1,309 @@
+#pragma once
+
+#include "mdp_ops.h"
+#include "policy_model.h"
+#include "linear_system_solver.h"
+#include "scheduler_enumeration.h"
+#include "feature_toggle.h"
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/*
+	Exhaustive search for the schedulers of an unfolded mdp with maximal mu - lambda * hVar.
+	Every scheduler needs two linear systems: the one for mu on the unfolded mdp,
+	then the one on the unfolded mdp with rewards modified by mu, whose value at the initial state is mu - lambda * hVar.
+*/
+
+/*
+	Evaluates mu and mu - lambda * hVar for a sequence of schedulers where consecutive ones differ in the decision of one state (see gray_code_enumerator).
+	Both linear systems are kept factorized, a changed decision only replaces one line of each by a low rank update.
+	The mdp with modified rewards is unfolded once: its transitions do not depend on mu, only its rewards,
+	which are evaluated per scheduler from the recorded arguments of the modification.
+*/
+class hVar_incremental_evaluator {
+	const rational_type lambda;
+
+	// mdp with normal rewards, for mu:
+	const state_index index;
+	const dense_policy_model model;
+	policy_matrix_builder builder;
+	linear_systems::incremental_linear_system system;
+	linear_systems::var_id initial;
+
+	// mdp with modified rewards, for mu - lambda * hVar:
+	std::vector<std::string> modified_ordered_variables;
+	scheduler_container modified_cont;
+	std::map<std::string, std::map<std::string, modified_reward_arguments>> reward_arguments;
+	const mdp modified_unfolded;
+	const state_index modified_index;
+	const dense_policy_model modified_model;
+	dense_policy_model::dense_scheduler modified_decisions;
+	policy_matrix_builder modified_builder;
+	std::vector<const modified_reward_arguments*> modified_action_arguments; // per entry of the action table of modified_model
+	linear_systems::incremental_linear_system modified_system;
+	linear_systems::var_id modified_initial;
+
+public:
+
+	/*
+		@param cont the first scheduler to be evaluated
+	*/
+	hVar_incremental_evaluator(const mdp& m, const mdp& first_unfolded_with_normal_rewwards, const rational_type& lambda, const rational_type& cut_level, const std::vector<std::string>& ordered_variables, const scheduler_container& cont, linear_systems::variable_ordering ordering) :
+		lambda(lambda),
+		index(make_state_index(ordered_variables)),
+		model(first_unfolded_with_normal_rewwards, ordered_variables, cont),
+		builder(model, model.make_dense_scheduler(ordered_variables, cont)),
+		modified_cont(cont),
+		// modification with the same zero rewards as arg - lambda * mu^2 for every mu, except for the state in front of the initial state, which is never resolved this way:
+		modified_unfolded(modified_stupid_unfold(m, cut_level, modified_ordered_variables, [](const rational_type& arg) { return arg + rational_type(1); }, modified_cont, &reward_arguments)),
+		modified_index(make_state_index(modified_ordered_variables)),
+		modified_model(modified_unfolded, modified_ordered_variables, modified_cont),
+		modified_decisions(modified_model.make_dense_scheduler(modified_ordered_variables, modified_cont)),
+		modified_builder(modified_model, modified_decisions)
+	{
+		initial = get_index(index, first_unfolded_with_normal_rewwards.initial); // initial state should be the first one, so == 0
+		if (initial != 0) {
+			standard_logger()->error("Internal error: exp-sched-index-of-initial-state");
+		}
+		system.factorize(builder.matrix(), builder.right_hand_side(), builder.unresolved_variables(ordering), builder.resolved_variables());
+
+		for (linear_systems::var_id state{ 0 }; state < modified_model.count_states(); ++state) {
+			const auto& actions{ modified_cont.available_actions_per_state.at(modified_ordered_variables[state]) };
+			for (std::size_t action{ 0 }; action < modified_model.count_actions(state); ++action) {
+				modified_action_arguments.push_back(&reward_arguments.at(modified_ordered_variables[state]).at(actions[action]));
+			}
+		}
+		modified_initial = get_index(modified_index, modified_unfolded.initial);
+		modified_system.factorize(modified_builder.matrix(), modified_builder.right_hand_side(), modified_builder.unresolved_variables(ordering), modified_builder.resolved_variables()); // the right hand side is set by evaluate()
+	}
+
+	void change_decision(const std::string& state, std::size_t action) {
+		const linear_systems::var_id v{ get_index(index, state) };
+		builder.change_decision(v, action);
+		system.replace_line(v, builder.line(v), builder.right_hand_side()[v]);
+
+		const auto found{ modified_index.find(state) };
+		if (found == modified_index.cend()) {
+			return;
+		}
+		modified_decisions[found->second] = action;
+		modified_builder.change_decision(found->second, action);
+		modified_system.replace_line(found->second, modified_builder.line(found->second), rational_type(0));
+	}
+
+	/*
+		@return mu and mu - lambda * hVar of the current scheduler
+	*/
+	std::pair<rational_type, rational_type> evaluate() {
+		linear_systems::rational_vector solution;
+		system.solve(solution);
+		const rational_type current_mu{ solution[initial] };
+
+		const rational_type shift{ lambda * std::max(rational_type(0), current_mu) * std::max(rational_type(0), current_mu) };
+		const auto modify{
+			[&](const rational_type& arg) {
+				return arg - shift;
+			}
+		};
+		linear_systems::rational_vector modified_rew(modified_model.count_states(), rational_type(0));
+		for (linear_systems::var_id state{ 0 }; state < modified_model.count_states(); ++state) {
+			if (!modified_model.is_resolved(state)) {
+				modified_rew[state] = modified_action_arguments[modified_model.global_action(state, modified_decisions[state])]->evaluate(modify);
+			}
+		}
+		modified_system.set_right_hand_side(std::move(modified_rew));
+		modified_system.solve(solution);
+		return std::make_pair(current_mu, solution[modified_initial]);
+	}
+
+};
+
+/*
+	Evaluates mu and mu - lambda * hVar of every scheduler from scratch with the configured solver backend:
+	both linear systems are built and solved again, the mdp with modified rewards is unfolded again.
+*/
+class hVar_full_evaluator {
+	const mdp& m;
+	const mdp& first_unfolded_with_normal_rewwards;
+	const rational_type lambda;
+	const rational_type cut_level;
+	const std::vector<std::string>& ordered_variables;
+	const scheduler_container& cont; // the current scheduler, changed by the caller
+	const linear_systems::solver_configuration solver;
+
+public:
+
+	hVar_full_evaluator(const mdp& m, const mdp& first_unfolded_with_normal_rewwards, const rational_type& lambda, const rational_type& cut_level, const std::vector<std::string>& ordered_variables, const scheduler_container& cont, const linear_systems::solver_configuration& solver) :
+		m(m),
+		first_unfolded_with_normal_rewwards(first_unfolded_with_normal_rewwards),
+		lambda(lambda),
+		cut_level(cut_level),
+		ordered_variables(ordered_variables),
+		cont(cont),
+		solver(solver)
+	{}
+
+	void change_decision(const std::string&, std::size_t) {
+		// nothing to do, evaluate() reads the decisions from cont
+	}
+
+	/*
+		@return mu and mu - lambda * hVar of the current scheduler
+	*/
+	std::pair<rational_type, rational_type> evaluate() const {
+
+		// to be filled in...
+		linear_systems::matrix mat;
+		linear_systems::rational_vector rew;
+		linear_systems::id_vector unresolved;
+		linear_systems::id_vector resolved;
+
+		// create matrix
+		create_matrix(first_unfolded_with_normal_rewwards, ordered_variables, cont, mat, rew, unresolved, resolved, solver.ordering);
+
+
+		std::size_t index_of_initial_state = std::find(ordered_variables.cbegin(), ordered_variables.cend(), first_unfolded_with_normal_rewwards.initial) - ordered_variables.cbegin(); // initial state should be the first one, so == 0
+		if (index_of_initial_state != 0) {
+			standard_logger()->error("Internal error: exp-sched-index-of-initial-state");
+		}
+
+		// solve matrix, only the value of the initial state is needed
+		solve_linear_system_targeted(solver.backend, mat, rew, unresolved, resolved, { index_of_initial_state }, solver.selection);
+
+		// we have mu for classical problem so far
+		linear_systems::rational_vector current_solution = rew;
+		rational_type current_mu = current_solution[index_of_initial_state];
+
+		const auto modify{
+			[&](const rational_type& arg) {
+				return arg - lambda * std::max(rational_type(0), current_mu) * std::max(rational_type(0), current_mu);
+			}
+		};
+
+		// now modify the rewards in m, so we can calculat ethe actual mu - \lambda hVar.
+
+		mdp unfolded_cut_with_modified_rewards;
+
+		std::vector<std::string> modified_ordered_variables;
+
+		scheduler_container cont2 = cont;
+
+		unfolded_cut_with_modified_rewards = modified_stupid_unfold(m, cut_level, modified_ordered_variables, modify, cont2);
+
+		// to be filled in...
+		linear_systems::matrix mat2;
+		linear_systems::rational_vector rew2;
+		linear_systems::id_vector unresolved2;
+		linear_systems::id_vector resolved2;
+
+		// create matrix
+		create_matrix(unfolded_cut_with_modified_rewards, modified_ordered_variables, cont2, mat2, rew2, unresolved2, resolved2, solver.ordering);
+
+
+		std::size_t index_of_initial_state2 = std::find(modified_ordered_variables.cbegin(), modified_ordered_variables.cend(), unfolded_cut_with_modified_rewards.initial) - modified_ordered_variables.cbegin(); // initial state should be the first one, so == 0
+
+		// solve matrix, only the value of the initial state is needed
+		solve_linear_system_targeted(solver.backend, mat2, rew2, unresolved2, resolved2, { index_of_initial_state2 }, solver.selection);
+
+		// we have mu for classical problem so far
+		linear_systems::rational_vector current_solution_with_hVar = rew2;
+		return std::make_pair(current_mu, current_solution_with_hVar[index_of_initial_state2]);
+	}
+
+};
+
+/*
+	Tries all schedulers of the unfolded mdp.
+	Without a solver backend given by the task or with automatic or incremental, they are evaluated by hVar_incremental_evaluator,
+	with every other backend given by the task by hVar_full_evaluator.
+	@return best mu - lambda * hVar, and mu and the scheduler of every scheduler reaching it, in Gray code order
+*/
+inline std::tuple<rational_type, std::vector <rational_type>, std::vector<scheduler_container>> check_all_exponential_schedulers_for_hVar(const mdp& m, const mdp& first_unfolded_with_normal_rewwards, const rational_type& lambda, const rational_type& cut_level, const std::vector<std::string>& ordered_variables, const linear_systems::solver_configuration& solver = linear_systems::solver_configuration()) {
+
+	scheduler_container cont;
+
+	cont.init(first_unfolded_with_normal_rewwards);
+
+	auto size_message = std::string("number of schedulers to be tested:   ") + cont.number_of_schedulers().numerator().str();
+	standard_logger()->trace(size_message);
+
+	const bool incremental{ !solver.backend_given || solver.backend == linear_systems::solver_backend::automatic || solver.backend == linear_systems::solver_backend::incremental_low_rank };
+	standard_logger()->info(incremental ?
+		std::string("Exhaustive scheduler search:   incremental evaluation by low rank updates") :
+		std::string("Exhaustive scheduler search:   full evaluation of every scheduler by   ") + linear_systems::to_string(solver.backend));
+
+	// best schedulers of one chunk of the scheduler index space, in index order:
+	struct best_schedulers {
+		bool first_result_found{ false };
+		rational_type best_seen_result;
+		std::vector <rational_type> mu_for_best_seen_result;
+		std::vector<scheduler_container> best_seen_scheduler;
+		linear_systems::solver_statistics statistics; // only used if solver.collect_statistics
+
+		/*
+			forgets the schedulers seen so far if current_mu_minus_hVar is better
+			@return true if schedulers with current_mu_minus_hVar belong to the best ones
+		*/
+		bool keep(const rational_type& current_mu_minus_hVar) {
+			if (!first_result_found || current_mu_minus_hVar > best_seen_result) {
+				first_result_found = true;
+				best_seen_result = current_mu_minus_hVar;
+				mu_for_best_seen_result.clear();
+				best_seen_scheduler.clear();
+			}
+			return current_mu_minus_hVar == best_seen_result;
+		}
+	};
+
+	// the schedulers are enumerated in Gray code order, so an incremental evaluator only needs to update one decision per scheduler:
+	const auto search = [&](auto& evaluator, scheduler_container& current, gray_code_enumerator& gray, const big_int_type& count) {
+		best_schedulers result;
+		for (big_int_type i{ 0 }; i < count; ++i) {
+			if (i != 0) {
+				const std::size_t changed{ gray.next() };
+				evaluator.change_decision(gray.state(changed), gray.decision(changed));
+			}
+			const auto [current_mu, current_mu_minus_hVar] = evaluator.evaluate();
+			if (result.keep(current_mu_minus_hVar)) {
+				result.mu_for_best_seen_result.push_back(current_mu);
+				result.best_seen_scheduler.push_back(current);
+			}
+		}
+		return result;
+	};
+	auto chunks = for_each_scheduler_chunk(cont, feature_toggle::COUNT_THREADS, [&](const big_int_type& begin, const big_int_type& count) {
+		scheduler_container current{ cont };
+		gray_code_enumerator gray(current, begin);
+		linear_systems::solver_statistics statistics;
+		const linear_systems::solver_statistics_scope statistics_scope(solver.collect_statistics ? &statistics : nullptr);
+		best_schedulers result;
+		if (incremental) {
+			hVar_incremental_evaluator evaluator(m, first_unfolded_with_normal_rewwards, lambda, cut_level, ordered_variables, current, solver.ordering);
+			result = search(evaluator, current, gray, count);
+		}
+		else {
+			hVar_full_evaluator evaluator(m, first_unfolded_with_normal_rewwards, lambda, cut_level, ordered_variables, current, solver);
+			result = search(evaluator, current, gray, count);
+		}
+		result.statistics = statistics;
+		return result;
+		});
+
+	best_schedulers merged;
+	for (auto& chunk : chunks) {
+		merged.statistics.add(chunk.statistics);
+		if (chunk.first_result_found && merged.keep(chunk.best_seen_result)) {
+			std::move(chunk.mu_for_best_seen_result.begin(), chunk.mu_for_best_seen_result.end(), std::back_inserter(merged.mu_for_best_seen_result));
+			std::move(chunk.best_seen_scheduler.begin(), chunk.best_seen_scheduler.end(), std::back_inserter(merged.best_seen_scheduler));
+		}
+	}
+	if (solver.collect_statistics) {
+		standard_logger()->info(std::string("Solver statistics summary:   ") + merged.statistics.to_json().dump());
+	}
+	return std::make_tuple(merged.best_seen_result, merged.mu_for_best_seen_result, merged.best_seen_scheduler);
+}
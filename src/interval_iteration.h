@@ -0,0 +1,355 @@
+#pragma once
+
+#include "policy_model.h"
+#include "modified_policy_iteration.h"
+#include "variable_ordering.h"
+
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+	Interval iteration for the maximal expected accumulated reward until reaching a target.
+
+	A lower bound L and an upper bound U of the optimal values are improved by Bellman updates
+		L(s) := max_a r(s, a) + sum_s' P(s, a, s') L(s'),   U(s) accordingly,
+	until U - L is at most the requested precision. The updates are done Gauss-Seidel style, strongly connected component after component,
+	successors first, so every component only needs to be iterated until it converged once.
+
+	Initial bounds: if K(s) >= 1 + max_a sum_s' P(s, a, s') K(s') for all unresolved states s and K = 0 on the resolved ones
+	(K bounds the expected number of steps until reaching a target or a state of value 0 under every scheduler),
+	then min(r_min, 0) * K is a lower and max(r_max, 0) * K an upper bound which both stay bounds when updated.
+	K is taken from a floating point policy iteration for the doubled number of steps, rounded up and checked exactly.
+	Such a K only exists if every scheduler reaches the resolved states with probability 1, which is checked by prob1A first.
+
+	Soundness despite floating point: every updated bound is moved outwards by a bound on the rounding error of its update,
+	and the final bounds are verified exactly: L <= T L and U >= T U in rational arithmetic, T the Bellman operator.
+	As every scheduler reaches the resolved states, this implies L <= optimal values <= U.
+*/
+
+class interval_iteration_error : public std::logic_error {
+
+public:
+
+	template <class T>
+	interval_iteration_error(const T& arg) : std::logic_error(arg) {}
+
+	template <class T>
+	static void check(const T& message, bool check_result) {
+		if (!check_result) throw interval_iteration_error(message);
+	}
+};
+
+struct interval_iteration_configuration {
+	bool enabled{ false }; // if not, optimize_scheduler does exact policy iteration
+	rational_type precision{ 1, 1000000 }; // absolute, maximal U - L
+	std::size_t max_sweeps_per_component{ 1000000 };
+};
+
+template <class Float = long double>
+struct interval_iteration_result {
+	std::vector<Float> lower;
+	std::vector<Float> upper;
+	std::size_t sweeps{ 0 };
+	Float max_gap{ 0 };
+
+	// lower and upper as exact rationals, verified as bounds (see top of file):
+	std::vector<rational_type> exact_lower;
+	std::vector<rational_type> exact_upper;
+	rational_type exact_max_gap{ 0 };
+};
+
+/*
+	@return smallest integer >= value, value must be finite
+*/
+template <class Float>
+big_int_type ceil_to_big_int(Float value) {
+	const bool negative{ value < 0 };
+	int exponent;
+	const Float mantissa{ std::frexp(std::fabs(value), &exponent) }; // |value| = mantissa * 2^exponent, mantissa in [0.5, 1)
+	constexpr int MANTISSA_BITS{ 64 }; // enough for the digits of double and x87 long double
+	big_int_type integer_mantissa{ static_cast<std::uint64_t>(std::ldexp(mantissa, MANTISSA_BITS)) };
+	const int shift{ exponent - MANTISSA_BITS };
+	if (shift >= 0) {
+		integer_mantissa <<= shift;
+		return negative ? big_int_type(-integer_mantissa) : integer_mantissa;
+	}
+	const big_int_type truncated{ integer_mantissa >> -shift };
+	const bool has_fraction{ (truncated << -shift) != integer_mantissa };
+	if (negative) {
+		return -truncated;
+	}
+	return has_fraction ? big_int_type(truncated + 1) : truncated;
+}
+
+/*
+	@return value as exact rational, value must be finite
+*/
+template <class Float>
+rational_type exact_rational(Float value) {
+	if (value == Float(0)) {
+		return rational_type(0);
+	}
+	int exponent;
+	const Float mantissa{ std::frexp(std::fabs(value), &exponent) }; // |value| = mantissa * 2^exponent, mantissa in [0.5, 1)
+	constexpr int MANTISSA_BITS{ 64 }; // enough for the digits of double and x87 long double
+	big_int_type integer_mantissa{ static_cast<std::uint64_t>(std::ldexp(mantissa, MANTISSA_BITS)) };
+	const int shift{ exponent - MANTISSA_BITS };
+	rational_type result{ shift >= 0 ? rational_type(big_int_type(integer_mantissa << shift)) : rational_type(integer_mantissa, big_int_type(big_int_type(1) << -shift)) };
+	return value < Float(0) ? rational_type(-result) : result;
+}
+
+/*
+	Converts the bounds of result to rationals and checks them exactly, see top of file.
+	@return true if lower and upper are bounds of the optimal values
+*/
+template <class Float>
+bool verify_bounds_exactly(const dense_policy_model& model, interval_iteration_result<Float>& result) {
+	result.exact_lower.clear();
+	result.exact_upper.clear();
+	for (linear_systems::var_id state{ 0 }; state < model.count_states(); ++state) {
+		result.exact_lower.push_back(exact_rational(result.lower[state]));
+		result.exact_upper.push_back(exact_rational(result.upper[state]));
+	}
+	result.exact_max_gap = 0;
+	for (linear_systems::var_id state{ 0 }; state < model.count_states(); ++state) {
+		if (model.is_resolved(state)) {
+			if (result.exact_lower[state] > rational_type(0) || result.exact_upper[state] < rational_type(0)) {
+				return false;
+			}
+			continue;
+		}
+		for (std::size_t action{ 0 }; action < model.count_actions(state); ++action) {
+			if (model.action_value(state, action, result.exact_upper) > result.exact_upper[state]) {
+				return false;
+			}
+		}
+		bool lower_reached{ false };
+		for (std::size_t action{ 0 }; action < model.count_actions(state) && !lower_reached; ++action) {
+			lower_reached = model.action_value(state, action, result.exact_lower) >= result.exact_lower[state];
+		}
+		if (!lower_reached) {
+			return false;
+		}
+		result.exact_max_gap = std::max(result.exact_max_gap, result.exact_upper[state] - result.exact_lower[state]);
+	}
+	return true;
+}
+
+/*
+	@return K with K(s) >= 1 + max_a sum_s' P(s, a, s') K(s') for all unresolved states, K = 0 on resolved states, checked exactly.
+*/
+template <class Float = long double>
+std::vector<big_int_type> expected_steps_bound(const dense_policy_model& model, const approximate_policy_model<Float>& approximate, linear_systems::variable_ordering ordering) {
+	constexpr std::size_t MAX_ROUNDS{ 1000 };
+	const Float tolerance{ std::sqrt(std::numeric_limits<Float>::epsilon()) };
+
+	const std::vector<bool> surely_resolved{ prob1A(model.make_qualitative_graph(), model.resolved_flags()) };
+	interval_iteration_error::check("Interval iteration: no bound for the expected number of steps, some scheduler does not reach the target.",
+		std::find(surely_resolved.cbegin(), surely_resolved.cend(), false) == surely_resolved.cend());
+
+	// policy iteration for the maximal expected number of steps, each step counted twice for some slack against rounding:
+	dense_policy_model::dense_scheduler decisions(model.count_states(), 0);
+	std::vector<Float> steps;
+	bool changed{ true };
+	for (std::size_t round{ 0 }; changed && round < MAX_ROUNDS; ++round) {
+		linear_systems::matrix mat;
+		linear_systems::rational_vector rew;
+		linear_systems::id_vector unresolved;
+		linear_systems::id_vector resolved;
+		model.create_matrix(decisions, mat, rew, unresolved, resolved, ordering);
+		try {
+			const auto factorization{ linear_systems::factorize_linear_system<Float>(mat, unresolved, resolved) };
+			steps.assign(model.count_states(), Float(0));
+			for (const auto& v : unresolved) {
+				steps[v] = Float(2);
+			}
+			factorization.solve(steps);
+		}
+		catch (const linear_system_error&) {
+			throw interval_iteration_error("Interval iteration: no bound for the expected number of steps, some scheduler does not reach the target.");
+		}
+		interval_iteration_error::check("Interval iteration: no bound for the expected number of steps, some scheduler does not reach the target.",
+			std::all_of(steps.cbegin(), steps.cend(), [](const Float& value) { return std::isfinite(value) && value >= Float(0); }));
+
+		changed = false;
+		for (linear_systems::var_id state{ 0 }; state < model.count_states(); ++state) {
+			if (model.is_resolved(state)) {
+				continue;
+			}
+			Float best_seen_value{ approximate.expectation(state, decisions[state], steps) };
+			for (std::size_t action{ 0 }; action < model.count_actions(state); ++action) {
+				const Float value{ approximate.expectation(state, action, steps) };
+				if (value > best_seen_value + tolerance * std::max(Float(1), best_seen_value)) {
+					decisions[state] = action;
+					best_seen_value = value;
+					changed = true;
+				}
+			}
+		}
+	}
+
+	std::vector<big_int_type> bound(model.count_states(), big_int_type(0));
+	for (linear_systems::var_id state{ 0 }; state < model.count_states(); ++state) {
+		if (!model.is_resolved(state)) {
+			bound[state] = ceil_to_big_int(steps[state]) + 1;
+		}
+	}
+	const auto is_bound = [&]() {
+		for (linear_systems::var_id state{ 0 }; state < model.count_states(); ++state) {
+			if (model.is_resolved(state)) {
+				continue;
+			}
+			for (std::size_t action{ 0 }; action < model.count_actions(state); ++action) {
+				const std::size_t a{ model.global_action(state, action) };
+				rational_type expected{ 1 };
+				for (std::size_t t{ model.transitions_begin(a) }; t < model.transitions_end(a); ++t) {
+					expected += model.probability(t) * rational_type(bound[model.successor(t)]);
+				}
+				if (rational_type(bound[state]) < expected) {
+					return false;
+				}
+			}
+		}
+		return true;
+	};
+	for (std::size_t doubling{ 0 }; !is_bound(); ++doubling) {
+		interval_iteration_error::check("Interval iteration: could not verify a bound for the expected number of steps.", doubling < 8);
+		for (auto& value : bound) {
+			value *= 2;
+		}
+	}
+	return bound;
+}
+
+/*
+	see top of file
+	@throws interval_iteration_error if no initial bounds can be found or the final bounds cannot be verified
+*/
+template <class Float = long double>
+interval_iteration_result<Float> interval_iteration(const dense_policy_model& model, const interval_iteration_configuration& configuration, linear_systems::variable_ordering ordering) {
+	const approximate_policy_model<Float> approximate(model);
+	const Float precision{ linear_systems::rational_to_floating_point<Float>(configuration.precision) };
+	const Float rounding_slack{ 1 + 8 * std::numeric_limits<Float>::epsilon() };
+
+	interval_iteration_result<Float> result;
+	{
+		const std::vector<big_int_type> steps_bound{ expected_steps_bound(model, approximate, ordering) };
+		const Float lowest{ std::min(approximate.min_reward(), Float(0)) * rounding_slack };
+		const Float highest{ std::max(approximate.max_reward(), Float(0)) * rounding_slack };
+		result.lower.reserve(model.count_states());
+		result.upper.reserve(model.count_states());
+		for (const auto& steps : steps_bound) {
+			if (steps == 0) { // resolved, avoid -0 from a negative lowest
+				result.lower.push_back(Float(0));
+				result.upper.push_back(Float(0));
+				continue;
+			}
+			const Float steps_float{ steps.template convert_to<Float>() * rounding_slack };
+			result.lower.push_back(lowest * steps_float);
+			result.upper.push_back(highest * steps_float);
+		}
+	}
+
+	// all bounds stay within [-scale, scale], so an update r + sum P v with at most max_fan_out successors has a rounding error below outwards:
+	Float scale{ 0 };
+	for (linear_systems::var_id state{ 0 }; state < model.count_states(); ++state) {
+		scale = std::max({ scale, std::fabs(result.lower[state]), std::fabs(result.upper[state]) });
+	}
+	std::size_t max_fan_out{ 0 };
+	for (std::size_t a{ 0 }; a < model.count_all_actions(); ++a) {
+		max_fan_out = std::max(max_fan_out, model.transitions_end(a) - model.transitions_begin(a));
+	}
+	const Float outwards{ 4 * Float(max_fan_out + 2) * std::numeric_limits<Float>::epsilon() * scale };
+
+	// strongly connected components of the graph of all actions, successors first:
+	std::vector<linear_systems::id_vector> successors(model.count_states());
+	linear_systems::id_vector all_states;
+	for (linear_systems::var_id state{ 0 }; state < model.count_states(); ++state) {
+		all_states.push_back(state);
+		for (std::size_t action{ 0 }; action < model.count_actions(state); ++action) {
+			const std::size_t a{ model.global_action(state, action) };
+			for (std::size_t t{ model.transitions_begin(a) }; t < model.transitions_end(a); ++t) {
+				successors[state].push_back(model.successor(t));
+			}
+		}
+	}
+	const auto components{ linear_systems::strongly_connected_components(successors, all_states) };
+
+	auto& lower{ result.lower };
+	auto& upper{ result.upper };
+	for (const auto& component : components) {
+		const bool trivial{ component.size() == 1 &&
+			std::find(successors[component.front()].cbegin(), successors[component.front()].cend(), component.front()) == successors[component.front()].cend() };
+		for (std::size_t sweep{ 0 }; sweep < configuration.max_sweeps_per_component; ++sweep) {
+			++result.sweeps;
+			bool changed{ false };
+			Float component_gap{ 0 };
+			for (const auto& state : component) {
+				if (model.is_resolved(state)) {
+					continue;
+				}
+				Float best_lower{ -std::numeric_limits<Float>::infinity() };
+				Float best_upper{ -std::numeric_limits<Float>::infinity() };
+				for (std::size_t action{ 0 }; action < model.count_actions(state); ++action) {
+					best_lower = std::max(best_lower, approximate.action_value(state, action, lower));
+					best_upper = std::max(best_upper, approximate.action_value(state, action, upper));
+				}
+				// bounds may only get tighter, also in the presence of rounding:
+				if (best_lower - outwards > lower[state]) {
+					lower[state] = best_lower - outwards;
+					changed = true;
+				}
+				if (best_upper + outwards < upper[state]) {
+					upper[state] = best_upper + outwards;
+					changed = true;
+				}
+				component_gap = std::max(component_gap, upper[state] - lower[state]);
+			}
+			if (trivial || !changed || component_gap <= precision) {
+				break;
+			}
+		}
+	}
+	for (linear_systems::var_id state{ 0 }; state < model.count_states(); ++state) {
+		result.max_gap = std::max(result.max_gap, upper[state] - lower[state]);
+	}
+	interval_iteration_error::check("Interval iteration: the floating point bounds could not be verified exactly.", verify_bounds_exactly(model, result));
+	return result;
+}
+
+/*
+	An action can only be excluded from being optimal if its value for the upper bounds is below the value of another action of the same state for the lower bounds.
+	Compared exactly with the verified bounds, so an excluded action is certainly not optimal.
+	@return per state the indices of the actions that may be optimal, ascending
+*/
+template <class Float>
+std::vector<std::vector<std::size_t>> possibly_optimal_actions(const dense_policy_model& model, const interval_iteration_result<Float>& bounds) {
+	std::vector<std::vector<std::size_t>> result(model.count_states());
+	for (linear_systems::var_id state{ 0 }; state < model.count_states(); ++state) {
+		if (model.count_actions(state) == 0) {
+			continue;
+		}
+		rational_type best_lower{ model.action_value(state, 0, bounds.exact_lower) };
+		for (std::size_t action{ 1 }; action < model.count_actions(state); ++action) {
+			best_lower = std::max(best_lower, model.action_value(state, action, bounds.exact_lower));
+		}
+		for (std::size_t action{ 0 }; action < model.count_actions(state); ++action) {
+			if (model.action_value(state, action, bounds.exact_upper) >= best_lower) {
+				result[state].push_back(action);
+			}
+		}
+	}
+	return result;
+}
+
+template <class Float>
+std::string to_decimal_string(Float value) {
+	std::ostringstream stream;
+	stream << std::setprecision(std::numeric_limits<Float>::max_digits10) << value;
+	return stream.str();
+}
@@ -1,26 +1,22 @@
 #pragma once
 
 #include "custom_types.h"
+#include "linear_system_types.h"
+#include "solver_statistics.h"
+#include "sparse_rows.h"
 
 namespace feature_toggle {
 	constexpr bool LINEAR_SYSTEMS_DEBUG_OUTPUT{ true }; //### addd some debug level output
 	constexpr bool LINEAR_SYSTEMS_DEBUG_CHECKS{ true };
 }
 
-namespace linear_systems {
-	using var_id = std::size_t;
-	using id_vector = std::vector<var_id>;
-	using rational_vector = std::vector<rational_type>;
-	using matrix_entry = std::pair<std::size_t, rational_type>;
-	using matrix_line = std::vector<matrix_entry>;
-	using matrix = std::vector<matrix_line>;
-}
-
-void print_mat(const linear_systems::matrix& mat, const linear_systems::rational_vector& r) {
+inline void print_mat(const linear_systems::pooled_sparse_rows<rational_type>& mat, const linear_systems::rational_vector& r) {
 	for (std::size_t i = 0; i < mat.size(); ++i) {
 		standard_logger()->trace(std::to_string(i) + ":");
-		for (const auto& pair : mat[i]) {
-			standard_logger()->trace(std::string("     next:  [") + std::to_string(pair.first) + "] :   " + pair.second.numerator().str() + "/" + pair.second.denominator().str());
+		for (std::size_t position = mat.begin(i); position < mat.end(i); ++position) {
+			if (!mat.is_erased(position)) {
+				standard_logger()->trace(std::string("     next:  [") + std::to_string(mat.column(position)) + "] :   " + mat.value(position).numerator().str() + "/" + mat.value(position).denominator().str());
+			}
 		}
 		standard_logger()->trace(std::string("     rew:  ") + r[i].numerator().str() + "/" + r[i].denominator().str());
 	}
@@ -128,105 +124,104 @@ inline void inline_move_resolved_line(
 	resolved_variables.push_back(x_id);
 }
 
-inline bool compare_id_rational_pair(const linear_systems::matrix_entry& l, const linear_systems::matrix_entry& r) {
-	return l.first < r.first;
+namespace linear_systems {
+
+	/*
+		The lines of the dependency order solver, see pooled_sparse_rows: erasing an entry leaves a tombstone, merging two lines writes the result in place if it fits.
+	*/
+	using dependency_order_rows = pooled_sparse_rows<rational_type>;
+
+	/*
+		@return column of the first live entry of line, the line itself if there is none
+	*/
+	inline var_id first_live_column(const dependency_order_rows& P, var_id line) {
+		for (std::size_t position{ P.begin(line) }; position < P.end(line); ++position) {
+			if (!P.is_erased(position)) {
+				return P.column(position);
+			}
+		}
+		return line;
+	}
+
 }
 
 inline void inline_normalize_resolved_line(
-	linear_systems::matrix& P_table,
+	linear_systems::dependency_order_rows& P_table,
 	linear_systems::rational_vector& rew_vector,
 	linear_systems::var_id id_resolved
 ) {
+	const std::size_t diagonal{ P_table.find(id_resolved, id_resolved) };
 	if constexpr (feature_toggle::LINEAR_SYSTEMS_DEBUG_CHECKS) {
-		if (P_table[id_resolved].size() != 1) {
-			throw resolved_line_of_wrong_size("Normalizing a resolved line", id_resolved, P_table[id_resolved].size());
+		if (P_table.count_entries(id_resolved) != 1) {
+			throw resolved_line_of_wrong_size("Normalizing a resolved line", id_resolved, P_table.count_entries(id_resolved));
 		}
-		if (P_table[id_resolved][0].first != id_resolved) {
-			throw ill_formed_new_resolved_line("Normalizing a resolved line", id_resolved, P_table[id_resolved][0].first);
+		if (diagonal == P_table.npos) {
+			throw ill_formed_new_resolved_line("Normalizing a resolved line", id_resolved, linear_systems::first_live_column(P_table, id_resolved));
 		}
-		if (P_table[id_resolved][0].second == rational_type(0)) {
+		if (P_table.value(diagonal) == rational_type(0)) {
 			throw unexpected_zero_coefficient("Normalizing a resolved line", id_resolved, id_resolved);
 		} // means we have ambiguous solutions...
 	}
-	rew_vector[id_resolved] /= P_table[id_resolved][0].second;
-	P_table[id_resolved][0].second = 1;
+	rew_vector[id_resolved] /= P_table.value(diagonal);
+	P_table.value(diagonal) = 1;
+	if (auto statistics = linear_systems::active_solver_statistics()) {
+		++statistics->eliminations;
+		statistics->record_coefficient(rew_vector[id_resolved]);
+	}
 }
 
 
 /*
 	see requirements in the checks of the first lines!
-	@after x_j in line_i will have an entry with 0-coefficient, others might have a 0-coefficient too!
+	@after x_j is erased from line_i, other entries which became 0 except the diagonal as well
 */
 inline void resolve_x_j_in_line_i_using_line_j(
-	linear_systems::matrix& P_table, // lines are sorted and kept sorted
+	linear_systems::dependency_order_rows& P_table,
 	linear_systems::rational_vector& r,
 	linear_systems::var_id line_i,
-	linear_systems::var_id line_j,
-	linear_systems::matrix_line::iterator iter_on_x_j_inside_line_i
+	linear_systems::var_id line_j
 ) {
 	using namespace linear_systems;
 
-	const auto iter_on_x_j_inside_line_j = std::lower_bound(P_table[line_j].begin(), P_table[line_j].end(), std::make_pair(line_j, rational_type()), compare_id_rational_pair);
+	// positions are looked up here, merging other lines may have compacted the pools:
+	const std::size_t position_of_x_j_inside_line_i{ P_table.find(line_i, line_j) };
+	const std::size_t position_of_x_j_inside_line_j{ P_table.find(line_j, line_j) };
 	standard_logger()->info(std::string("########################### with i, j:   ") + std::to_string(line_i) + "   " + std::to_string(line_j));
 	print_mat(P_table, r);
 	if (feature_toggle::LINEAR_SYSTEMS_DEBUG_CHECKS) {
-		if (iter_on_x_j_inside_line_j == P_table[line_j].end()) {
+		if (position_of_x_j_inside_line_i == P_table.npos) {
+			throw linear_system_error("Should apply resolve_x_j_in_line_i_using_line_j but x_j in line_i does not exist");
+		}
+		if (position_of_x_j_inside_line_j == P_table.npos) {
 			throw linear_system_error("Should apply resolve_x_j_in_line_i_using_line_j but x_j in line_j does not exist");
 		}
-		if (iter_on_x_j_inside_line_j->second == rational_type(0)) {
+		if (P_table.value(position_of_x_j_inside_line_j) == rational_type(0)) {
 			throw linear_system_error("Should apply resolve_x_j_in_line_i_using_line_j but x_j in line_j has zero coefficient");
 		}
 		// remark both are forbidden per desgin of probability matrices.
 	}
-	const rational_type equation_multiply_factor{ iter_on_x_j_inside_line_i->second / iter_on_x_j_inside_line_j->second };
+	const rational_type equation_multiply_factor{ P_table.value(position_of_x_j_inside_line_i) / P_table.value(position_of_x_j_inside_line_j) };
 	// resolve the variable "line_j" in equation "line_i"
 	// P_table[line_i] -= equation_multiply_factor * "line_j" // -> coefficient of line_j in line_i will be zero.
-	matrix_line::iterator iter{ P_table[line_i].begin() };
-	matrix_line::iterator jter{ P_table[line_j].begin() };
 	r[line_i] -= r[line_j] * equation_multiply_factor;
 
-	matrix_line the_new_line_i;
-	while (true) {
-		if (iter == P_table[line_i].end()) {
-			for (; jter != P_table[line_j].end(); ++jter) {
-				the_new_line_i.push_back(*jter);
-				the_new_line_i.back().second *= rational_type(-1) * equation_multiply_factor;
-			}
-			P_table[line_i] = std::move(the_new_line_i);
-			return;
-		}
-		if (jter == P_table[line_j].end()) {
-			for (; iter != P_table[line_i].end(); ++iter) {
-				the_new_line_i.push_back(*iter);
+	id_vector fill_in;
+	P_table.subtract_multiple_of_row(line_i, equation_multiply_factor, line_j, line_j, fill_in);
+
+	if (auto statistics = active_solver_statistics()) {
+		++statistics->row_merges;
+		statistics->fill_in += fill_in.size();
+		for (std::size_t position{ P_table.begin(line_i) }; position < P_table.end(line_i); ++position) {
+			if (!P_table.is_erased(position)) {
+				statistics->record_coefficient(P_table.value(position));
 			}
-			P_table[line_i] = std::move(the_new_line_i);
-			return;
-		}
-		if (iter->first < jter->first) {
-			// only line_i has an entry for this variable..
-			the_new_line_i.push_back(*iter);
-			++iter;
-			continue;
-		}
-		if (iter->first > jter->first) {
-			// only "line_j" has an entry for this variable
-			the_new_line_i.push_back(*jter);
-			the_new_line_i.back().second *= rational_type(-1) * equation_multiply_factor;
-			++jter;
-			continue;
-		}
-		if (iter->first == jter->first) {
-			the_new_line_i.push_back(*iter);
-			the_new_line_i.back().second -= equation_multiply_factor * jter->second;
-			++iter;
-			++jter;
-			continue;
 		}
+		statistics->record_coefficient(r[line_i]);
 	}
 }
 
 inline void apply_resolved_variables_on_unresolved_ones(
-	linear_systems::matrix& P, // lines are ordered, order is kept
+	linear_systems::dependency_order_rows& P,
 	linear_systems::rational_vector& r,
 	linear_systems::id_vector& unresolved, // they have an external order. it should be kept.
 	linear_systems::id_vector& resolved,
@@ -240,15 +235,14 @@ rerun_apply_resolved_variables:
 	// apply resolved lines to all unresolved lines:
 	for (const auto& resolved_id : resolved) {
 		for (const auto& unresolved_line : unresolved) {
-			auto found = std::lower_bound(
-				P[unresolved_line].cbegin(),
-				P[unresolved_line].cend(),
-				std::make_pair(resolved_id, rational_type(0)),
-				compare_id_rational_pair);
-			if (found != P[unresolved_line].cend() && found->first == resolved_id) {
-				r[unresolved_line] -= r[resolved_id] * found->second; // does not matter if the coefficient was zero.
-				P[unresolved_line].erase(found);
-				if (P[unresolved_line].size() < 2) {
+			const std::size_t found{ P.find(unresolved_line, resolved_id) };
+			if (found != P.npos) {
+				r[unresolved_line] -= r[resolved_id] * P.value(found); // does not matter if the coefficient was zero.
+				P.erase(unresolved_line, found);
+				if (auto statistics = active_solver_statistics()) {
+					++statistics->substitutions;
+				}
+				if (P.count_entries(unresolved_line) < 2) {
 					// the line is resolved;
 					unresolved_to_resolved.push_back(unresolved_line);
 				}
@@ -261,17 +255,17 @@ rerun_apply_resolved_variables:
 		// normalize the new resolved lines, do checks if enables
 		for (const auto& movee : unresolved_to_resolved) {
 			if constexpr (feature_toggle::LINEAR_SYSTEMS_DEBUG_CHECKS) {
-				if (P[movee].size() != 1) {
+				if (P.count_entries(movee) != 1) {
 					throw resolved_line_of_wrong_size(
 						"Moving newly resolved lines inside apply_resolved_variables_on_unresolved_ones",
 						movee,
-						P[movee].size());
+						P.count_entries(movee));
 				}
-				if (P[movee][0].first != movee) {
+				if (P.find(movee, movee) == P.npos) {
 					throw ill_formed_new_resolved_line(
 						"Moving newly resolved lines inside apply_resolved_variables_on_unresolved_ones",
 						movee,
-						P[movee][0].first);
+						first_live_column(P, movee));
 				}
 			}
 			inline_normalize_resolved_line(P, r, movee);
@@ -305,9 +299,10 @@ rerun_apply_resolved_variables:
 			Its order is crucial for the performance of solving.
 			As far as possible a variable x that depends on y should appear prior to y in this vector.
 	@param resolved should be disjoint with unresolved. Together both vectors need to cover all variables. Lines must be in trivial form p * x_i = r_i.
+	The lines are kept as pooled_sparse_rows while solving.
 */
 inline void solve_linear_system_dependency_order_optimized(
-	linear_systems::matrix P,
+	linear_systems::matrix P_lines,
 	linear_systems::rational_vector& r,
 	linear_systems::id_vector unresolved, // they have an external order. it should be kept.
 	linear_systems::id_vector resolved // is not required to be ordered.
@@ -318,17 +313,14 @@ inline void solve_linear_system_dependency_order_optimized(
 	id_vector done; // not sorted
 	// node s   |->   {(s1', r1) (s2',r2) (s3',r3), (self,-1)} "=  r_alpha"
 
+	// sorts all lines (the caller does not need to satisfy this condition):
+	dependency_order_rows P(std::move(P_lines));
 
 	// normailze resolved lines (the caller does not need to satisfy this condition):
 	for (const auto& resolved_id : resolved) {
 		inline_normalize_resolved_line(P, r, resolved_id);
 	}
 
-	// sort all lines of P (the caller does not need to satisfy this condition):
-	for (std::size_t i{ 0 }; i < P.size(); ++i) {
-		std::sort(P[i].begin(), P[i].end(), compare_id_rational_pair);
-	}
-
 	/*
 		inner constraints:
 			* The order of unresolved has to be kept. The last elements have priority for resolving.
@@ -344,7 +336,7 @@ rerun__solve_linear_system_dependency_order_optimized:
 	/*
 		Here we do not have any resolved equations ($a_{m,n} * x_i = r_i$) anymore that we can apply to the unresolved equations.
 		All coefficients of resolved variables in unresolved equations are zero.
-		The corresponding pairs in the sparse matrix are erased.
+		The corresponding entries in the sparse matrix are erased.
 	*/
 	if (!unresolved.empty()) { // else we are done
 		/*
@@ -377,7 +369,7 @@ rerun__solve_linear_system_dependency_order_optimized:
 		{
 		begin_of_inner_while:
 			// check high_prio_select for already being resolved...
-			if (P[high_prio_select].size() < 2) {
+			if (P.count_entries(high_prio_select) < 2) {
 				// high_prio_select already resolved!
 
 				inline_normalize_resolved_line(P, rew_vector, high_prio_select);
@@ -387,25 +379,23 @@ rerun__solve_linear_system_dependency_order_optimized:
 
 			// select a line that high_prio_select depends on...
 			size_t select_next_dependent_line;
-			matrix_line::iterator iter_of_next_dependent_inside_high_prio_select;
-			for (auto iter = P[high_prio_select].begin(); true; ++iter) {
-				if (iter == P[high_prio_select].end())
+			for (std::size_t position{ P.begin(high_prio_select) }; true; ++position) {
+				if (position == P.end(high_prio_select))
 					// we should only reach this, if we erased elements (~7 lines below) so we cannot find something to resolve.
 					// high_prio_select is supposed to be resolved here...
 					//#### it is a point of possible inifinite loop here.... we should check here for being resolved, otherwise throw error, not solvable... (?), but of course
 					//#### per Design of probability LGS this case does not happen
 					goto begin_of_inner_while;
-				if (iter->first == high_prio_select) {
+				if (P.is_erased(position) || P.column(position) == high_prio_select) {
 					continue; // found diagonal entry, we cannot select this.
 				}
 				// we found some non-diagonal entry
-				if (iter->second == rational_type(0)) {
-					P[high_prio_select].erase(iter); // invalidates iterators -> need to jumpo out!!!!
-					goto begin_of_inner_while;
+				if (P.value(position) == rational_type(0)) {
+					P.erase(high_prio_select, position); // only a tombstone, positions stay valid
+					continue;
 				}
 				// we found some non-diagonal, non-zero entry, so choose this one
-				select_next_dependent_line = iter->first;
-				iter_of_next_dependent_inside_high_prio_select = iter;
+				select_next_dependent_line = P.column(position);
 				break;
 			}
 
@@ -426,35 +416,28 @@ rerun__solve_linear_system_dependency_order_optimized:
 
 
 			for (const auto& stack_line : resolve_stack) {
-
-			solve_linear_system_dependency_order_optimized___repeat_apply_previous_stack_line:
-				const auto x_stack_line_in_select_next_dependent_line = std::lower_bound(
-					P[select_next_dependent_line].begin(),
-					P[select_next_dependent_line].end(),
-					std::make_pair(stack_line, rational_type(0)),
-					compare_id_rational_pair);
-
-				if (x_stack_line_in_select_next_dependent_line != P[select_next_dependent_line].end() && x_stack_line_in_select_next_dependent_line->first == stack_line) { // if line is a variable in select_next_dependent_line
-					if (x_stack_line_in_select_next_dependent_line->second == rational_type(0)) { // if there is some 0-entry, remove it.
-						P[select_next_dependent_line].erase(x_stack_line_in_select_next_dependent_line); // invalidates iterators on P_table[select_next_dependent_line]!
-						if (P[select_next_dependent_line].size() < 2) {
-							// select_next_dependent_line became resolved.
-							inline_normalize_resolved_line(P, rew_vector, select_next_dependent_line);
-							inline_move_resolved_line(unresolved, resolved, select_next_dependent_line);
-							goto rerun__solve_linear_system_dependency_order_optimized;
-						}
-						goto solve_linear_system_dependency_order_optimized___repeat_apply_previous_stack_line; // need to jump because of invalidates oterators
+				const std::size_t x_stack_line_in_select_next_dependent_line{ P.find(select_next_dependent_line, stack_line) };
+				if (x_stack_line_in_select_next_dependent_line == P.npos) { // line is no variable in select_next_dependent_line
+					continue;
+				}
+				if (P.value(x_stack_line_in_select_next_dependent_line) == rational_type(0)) { // if there is some 0-entry, remove it.
+					P.erase(select_next_dependent_line, x_stack_line_in_select_next_dependent_line);
+					if (P.count_entries(select_next_dependent_line) < 2) {
+						// select_next_dependent_line became resolved.
+						inline_normalize_resolved_line(P, rew_vector, select_next_dependent_line);
+						inline_move_resolved_line(unresolved, resolved, select_next_dependent_line);
+						goto rerun__solve_linear_system_dependency_order_optimized;
 					}
-					resolve_x_j_in_line_i_using_line_j(
-						P,
-						r,
-						select_next_dependent_line,
-						stack_line,
-						x_stack_line_in_select_next_dependent_line);
+					continue;
 				}
+				resolve_x_j_in_line_i_using_line_j(
+					P,
+					r,
+					select_next_dependent_line,
+					stack_line);
 			}
 
-			if (P[select_next_dependent_line].size() < 2) {
+			if (P.count_entries(select_next_dependent_line) < 2) {
 				inline_normalize_resolved_line(P, rew_vector, select_next_dependent_line);
 				inline_move_resolved_line(unresolved, resolved, select_next_dependent_line);
 				goto rerun__solve_linear_system_dependency_order_optimized;
@@ -465,8 +448,7 @@ rerun__solve_linear_system_dependency_order_optimized:
 				P,
 				r,
 				high_prio_select,
-				select_next_dependent_line,
-				iter_of_next_dependent_inside_high_prio_select);
+				select_next_dependent_line);
 			// REMARK: Check "high_prio_select resolved?" is done at the top of next while(true) iteration
 
 			resolve_stack.push_back(select_next_dependent_line);
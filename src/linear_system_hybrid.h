@@ -0,0 +1,217 @@
+#pragma once
+
+#include "linear_system.h"
+#include "sparse_elimination.h"
+
+#include <cmath>
+#include <limits>
+
+/*
+	Hybrid solving:
+		1. solve Px = r in machine floating point,
+		2. recover exact rationals from the floating point values by continued fractions,
+		3. check Px = r line by line exactly,
+		4. solve exactly only the part of the system that may be affected by failed lines.
+*/
+
+namespace linear_systems {
+
+	/*
+		Finds the first convergent p/q of the continued fraction of value with |value - p/q| <= tolerance.
+		@return false if there is no such convergent with q <= max_denominator.
+	*/
+	template <class Float>
+	bool reconstruct_rational_by_continued_fraction(Float value, rational_type& result, const big_int_type& max_denominator, Float tolerance) {
+		if (!std::isfinite(value) || std::fabs(value) > Float(std::numeric_limits<long long>::max() / 2)) {
+			return false;
+		}
+		big_int_type h_prev{ 1 }, h_prev_prev{ 0 };
+		big_int_type k_prev{ 0 }, k_prev_prev{ 1 };
+		Float remainder{ value };
+		while (true) {
+			const Float floor_of_remainder{ std::floor(remainder) };
+			const big_int_type a{ static_cast<long long>(floor_of_remainder) };
+			const big_int_type h{ a * h_prev + h_prev_prev };
+			const big_int_type k{ a * k_prev + k_prev_prev };
+			if (k > max_denominator) {
+				return false;
+			}
+			if (std::fabs(value - h.convert_to<Float>() / k.convert_to<Float>()) <= tolerance) {
+				result = rational_type(h, k);
+				return true;
+			}
+			const Float fraction{ remainder - floor_of_remainder };
+			if (fraction == Float(0)) {
+				return false;
+			}
+			remainder = Float(1) / fraction;
+			if (!std::isfinite(remainder) || remainder > Float(std::numeric_limits<long long>::max() / 2)) {
+				return false;
+			}
+			h_prev_prev = std::move(h_prev);
+			h_prev = h;
+			k_prev_prev = std::move(k_prev);
+			k_prev = k;
+		}
+	}
+
+	/*
+		@return ids of all lines i where sum_j P_ij * x_j != r_i, lines marked in skip are not checked.
+	*/
+	inline id_vector lines_violated_by(const matrix& P, const rational_vector& r, const rational_vector& x, const std::vector<bool>& skip) {
+		id_vector violated;
+		for (var_id i{ 0 }; i < P.size(); ++i) {
+			if (skip[i]) {
+				continue;
+			}
+			rational_type accumulated{ 0 };
+			for (const auto& entry : P[i]) {
+				accumulated += entry.second * x[entry.first];
+			}
+			if (accumulated != r[i]) {
+				violated.push_back(i);
+			}
+		}
+		return violated;
+	}
+
+	/*
+		x_k can only be wrong if there is a path from k to a violated line in the dependency graph of P (k -> j iff P_kj != 0).
+		@return all such k as a bit mask
+	*/
+	inline std::vector<bool> variables_depending_on(const matrix& P, const id_vector& lines) {
+		std::vector<id_vector> dependents(P.size());
+		for (var_id i{ 0 }; i < P.size(); ++i) {
+			for (const auto& entry : P[i]) {
+				if (entry.first != i && entry.second != rational_type(0)) {
+					dependents[entry.first].push_back(i);
+				}
+			}
+		}
+		std::vector<bool> affected(P.size(), false);
+		id_vector to_expand;
+		for (const auto& line : lines) {
+			if (!affected[line]) {
+				affected[line] = true;
+				to_expand.push_back(line);
+			}
+		}
+		while (!to_expand.empty()) {
+			const var_id j{ to_expand.back() };
+			to_expand.pop_back();
+			for (const auto& k : dependents[j]) {
+				if (!affected[k]) {
+					affected[k] = true;
+					to_expand.push_back(k);
+				}
+			}
+		}
+		return affected;
+	}
+
+	/*
+		Fixes all variables with known exact values in system P, r.
+		The others are solved exactly by solve_linear_system_dependency_order_optimized.
+	*/
+	inline void solve_remaining_variables_exactly(
+		matrix& P,
+		rational_vector& r,
+		const rational_vector& known_values,
+		const std::vector<bool>& unknown,
+		const id_vector& unresolved
+	) {
+		id_vector remaining_unresolved;
+		id_vector remaining_resolved;
+		std::vector<bool> is_remaining_unresolved(P.size(), false);
+		for (const auto& i : unresolved) {
+			if (unknown[i]) {
+				remaining_unresolved.push_back(i);
+				is_remaining_unresolved[i] = true;
+			}
+		}
+		for (var_id i{ 0 }; i < P.size(); ++i) {
+			if (!unknown[i]) {
+				P[i] = { std::make_pair(i, rational_type(1)) };
+				r[i] = known_values[i];
+			}
+			if (!is_remaining_unresolved[i]) {
+				remaining_resolved.push_back(i);
+			}
+		}
+		solve_linear_system_dependency_order_optimized(std::move(P), r, std::move(remaining_unresolved), std::move(remaining_resolved));
+	}
+
+}
+
+/*
+	Same interface and result as solve_linear_system_dependency_order_optimized.
+	Exactness is kept by checking the reconstructed solution against the original system.
+	@param max_denominator bound for the denominators when reconstructing rationals from floating point values.
+*/
+template <class Float = long double>
+inline void solve_linear_system_hybrid_floating_point(
+	linear_systems::matrix P,
+	linear_systems::rational_vector& r,
+	linear_systems::id_vector unresolved, // they have an external order. it should be kept.
+	linear_systems::id_vector resolved, // is not required to be ordered.
+	const big_int_type& max_denominator = big_int_type(1) << 40
+) {
+	using namespace linear_systems;
+
+	// resolved lines are trivial, no need for floating point here:
+	rational_vector x(r.size());
+	for (const auto& resolved_id : resolved) {
+		auto diagonal = std::find_if(P[resolved_id].cbegin(), P[resolved_id].cend(), [&](const matrix_entry& e) { return e.first == resolved_id; });
+		if (diagonal == P[resolved_id].cend() || diagonal->second == rational_type(0)) {
+			throw unexpected_zero_coefficient("Hybrid floating point solving: resolved line", resolved_id, resolved_id);
+		}
+		x[resolved_id] = r[resolved_id] / diagonal->second;
+	}
+
+	id_vector elimination_order{ unresolved };
+	std::copy(resolved.cbegin(), resolved.cend(), std::back_inserter(elimination_order));
+
+	std::vector<Float> x_float = convert_vector<Float>(r, rational_to_floating_point<Float>);
+	const bool float_solved = solve_linear_system_sparse_elimination(
+		convert_matrix<Float>(P, rational_to_floating_point<Float>),
+		x_float,
+		elimination_order);
+
+	std::vector<bool> unknown(P.size(), false);
+	if (float_solved) {
+		for (const auto& id : unresolved) {
+			const Float tolerance{ std::pow(std::numeric_limits<Float>::epsilon(), Float(0.75)) * std::max(Float(1), std::fabs(x_float[id])) };
+			if (!reconstruct_rational_by_continued_fraction(x_float[id], x[id], max_denominator, tolerance)) {
+				unknown[id] = true;
+			}
+		}
+	}
+	else {
+		for (const auto& id : unresolved) {
+			unknown[id] = true;
+		}
+	}
+
+	// all variables without a reconstructed value are treated like being in a violated line:
+	id_vector violated_lines;
+	for (var_id i{ 0 }; i < P.size(); ++i) {
+		if (unknown[i]) {
+			violated_lines.push_back(i);
+		}
+	}
+	// only lines that do not depend on unknown variables can be checked:
+	const id_vector violated_lines_with_known_variables{ lines_violated_by(P, r, x, variables_depending_on(P, violated_lines)) };
+	std::copy(violated_lines_with_known_variables.cbegin(), violated_lines_with_known_variables.cend(), std::back_inserter(violated_lines));
+
+	if (violated_lines.empty()) {
+		r = std::move(x);
+		return;
+	}
+
+	const std::vector<bool> affected{ variables_depending_on(P, violated_lines) };
+	if constexpr (feature_toggle::LINEAR_SYSTEMS_DEBUG_OUTPUT) {
+		standard_logger()->debug(std::string("Hybrid solving: falling back to exact solving for ") +
+			std::to_string(std::count(affected.cbegin(), affected.cend(), true)) + " of " + std::to_string(P.size()) + " variables.");
+	}
+	solve_remaining_variables_exactly(P, r, x, affected, unresolved);
+}
@@ -0,0 +1,251 @@
+#pragma once
+
+#include "linear_system.h"
+#include "sparse_elimination.h"
+
+#include <cmath>
+#include <map>
+
+/*
+	Incremental solving of a sequence of systems Px = r that differ from each other in a few lines only,
+	as it happens between the iterations of policy iteration.
+
+	Let A be the factorized base matrix and B the current one, differing in lines i_1, ..., i_k only.
+	With E = [e_i_1, ..., e_i_k] and D = [d_1, ..., d_k], d_j = (B - A)^T e_i_j we have B = A + E D^T and Sherman-Morrison-Woodbury gives
+		B^(-1) r = A^(-1) r - Z (I + D^T Z)^(-1) D^T A^(-1) r,   Z = A^(-1) E.
+	So solving B costs k + 1 solves using the factorization of A and a dense k x k system.
+	The columns of Z only depend on A, they are kept until the next refactorization.
+*/
+
+namespace linear_systems {
+
+	/*
+		Solves the dense system S y = b exactly, gaussian elimination with search for a non-zero pivot.
+		@return false if S is singular.
+	*/
+	inline bool solve_dense_system(std::vector<rational_vector> S, rational_vector& b) {
+		const std::size_t k{ b.size() };
+		for (std::size_t column{ 0 }; column < k; ++column) {
+			std::size_t pivot_line{ column };
+			while (pivot_line < k && S[pivot_line][column] == rational_type(0)) {
+				++pivot_line;
+			}
+			if (pivot_line == k) {
+				return false;
+			}
+			std::swap(S[column], S[pivot_line]);
+			std::swap(b[column], b[pivot_line]);
+			for (std::size_t line{ column + 1 }; line < k; ++line) {
+				if (S[line][column] == rational_type(0)) {
+					continue;
+				}
+				const rational_type factor{ S[line][column] / S[column][column] };
+				for (std::size_t j{ column }; j < k; ++j) {
+					S[line][j] -= factor * S[column][j];
+				}
+				b[line] -= factor * b[column];
+			}
+		}
+		for (std::size_t line{ k }; line-- > 0;) {
+			for (std::size_t j{ line + 1 }; j < k; ++j) {
+				b[line] -= S[line][j] * b[j];
+			}
+			b[line] /= S[line][line];
+		}
+		return true;
+	}
+
+	/*
+		@return sum_j line_j * x_j
+	*/
+	inline rational_type line_times_vector(const matrix_line& line, const rational_vector& x) {
+		rational_type accumulated{ 0 };
+		for (const auto& entry : line) {
+			accumulated += entry.second * x[entry.first];
+		}
+		return accumulated;
+	}
+
+	/*
+		@return a - b, both lines sorted by variable id.
+	*/
+	inline matrix_line line_difference(const matrix_line& a, const matrix_line& b) {
+		matrix_line result;
+		auto iter = a.cbegin();
+		auto jter = b.cbegin();
+		while (iter != a.cend() || jter != b.cend()) {
+			if (jter == b.cend() || (iter != a.cend() && iter->first < jter->first)) {
+				result.push_back(*iter);
+				++iter;
+			}
+			else if (iter == a.cend() || jter->first < iter->first) {
+				result.emplace_back(jter->first, -jter->second);
+				++jter;
+			}
+			else {
+				if (iter->second != jter->second) {
+					result.emplace_back(iter->first, iter->second - jter->second);
+				}
+				++iter;
+				++jter;
+			}
+		}
+		return result;
+	}
+
+	class incremental_linear_system {
+		sparse_factorization<rational_type> factorization;
+		id_vector unresolved;
+		id_vector resolved;
+
+		matrix base_lines; // lines of the factorized matrix
+		matrix current_lines;
+		rational_vector current_rhs;
+
+		std::map<var_id, matrix_line> changed_lines; // line id -> current line minus base line
+		std::map<var_id, rational_vector> z_columns; // line id -> A^(-1) e_(line id) of the base matrix
+
+		bool factorized{ false };
+
+		static void sort_line(matrix_line& line) {
+			std::sort(line.begin(), line.end(), [](const matrix_entry& l, const matrix_entry& r) { return l.first < r.first; });
+		}
+
+		void refactorize() {
+			factorization = factorize_linear_system<rational_type>(current_lines, unresolved, resolved);
+			base_lines = current_lines;
+			changed_lines.clear();
+			z_columns.clear();
+			factorized = true;
+		}
+
+	public:
+
+		/*
+			Number of changed lines up to which a low rank update is preferred to a new factorization.
+		*/
+		std::size_t max_changed_lines() const {
+			return std::max<std::size_t>(8, static_cast<std::size_t>(std::sqrt(static_cast<double>(current_lines.size()))));
+		}
+
+		bool is_factorized() const {
+			return factorized;
+		}
+
+		std::size_t count_changed_lines() const {
+			return changed_lines.size();
+		}
+
+		/*
+			Sets the whole system, interface as for solve_linear_system_dependency_order_optimized.
+			The order unresolved, resolved is used as elimination order for all later factorizations.
+		*/
+		void factorize(matrix P, rational_vector r, id_vector new_unresolved, id_vector new_resolved) {
+			for (auto& line : P) {
+				sort_line(line);
+			}
+			current_lines = std::move(P);
+			current_rhs = std::move(r);
+			unresolved = std::move(new_unresolved);
+			resolved = std::move(new_resolved);
+			refactorize();
+		}
+
+		/*
+			Replaces line i and its right hand side, the factorization is kept.
+		*/
+		void replace_line(var_id i, matrix_line line, rational_type rhs) {
+			sort_line(line);
+			current_rhs[i] = std::move(rhs);
+			matrix_line difference{ line_difference(line, base_lines[i]) };
+			current_lines[i] = std::move(line);
+			if (difference.empty()) {
+				changed_lines.erase(i);
+			}
+			else {
+				changed_lines[i] = std::move(difference);
+			}
+		}
+
+		/*
+			Replaces the whole right hand side, the factorization and the low rank update are kept.
+		*/
+		void set_right_hand_side(rational_vector r) {
+			current_rhs = std::move(r);
+		}
+
+		/*
+			@param x contains the solution of the current system afterwards.
+		*/
+		void solve(rational_vector& x) {
+			if (!factorized) {
+				throw linear_system_error("Incremental solving: solve called before factorize.");
+			}
+			if (changed_lines.size() > max_changed_lines()) {
+				if (auto statistics = active_solver_statistics()) {
+					++statistics->refactorizations;
+				}
+				refactorize();
+			}
+
+			x = current_rhs;
+			factorization.solve(x);
+			if (changed_lines.empty()) {
+				return;
+			}
+
+			std::vector<const rational_vector*> Z;
+			for (const auto& [i, difference] : changed_lines) {
+				auto found = z_columns.find(i);
+				if (found == z_columns.end()) {
+					rational_vector e_i(current_lines.size(), rational_type(0));
+					e_i[i] = rational_type(1);
+					factorization.solve(e_i);
+					found = z_columns.emplace(i, std::move(e_i)).first;
+				}
+				Z.push_back(&found->second);
+			}
+
+			// capacitance matrix S = I + D^T Z and y = S^(-1) D^T x:
+			const std::size_t k{ changed_lines.size() };
+			if (auto statistics = active_solver_statistics()) {
+				statistics->low_rank_updated_lines += k;
+			}
+			std::vector<rational_vector> S(k, rational_vector(k, rational_type(0)));
+			rational_vector y(k);
+			std::size_t a{ 0 };
+			for (const auto& [i, difference] : changed_lines) {
+				for (std::size_t b{ 0 }; b < k; ++b) {
+					S[a][b] = line_times_vector(difference, *Z[b]);
+				}
+				S[a][a] += rational_type(1);
+				y[a] = line_times_vector(difference, x);
+				++a;
+			}
+			if (!solve_dense_system(std::move(S), y)) {
+				if constexpr (feature_toggle::LINEAR_SYSTEMS_DEBUG_OUTPUT) {
+					standard_logger()->debug("Incremental solving: singular capacitance matrix, refactorization.");
+				}
+				if (auto statistics = active_solver_statistics()) {
+					++statistics->refactorizations;
+				}
+				refactorize();
+				x = current_rhs;
+				factorization.solve(x);
+				return;
+			}
+			for (std::size_t b{ 0 }; b < k; ++b) {
+				if (y[b] == rational_type(0)) {
+					continue;
+				}
+				for (var_id v{ 0 }; v < x.size(); ++v) {
+					if ((*Z[b])[v] != rational_type(0)) {
+						x[v] -= (*Z[b])[v] * y[b];
+					}
+				}
+			}
+		}
+
+	};
+
+}
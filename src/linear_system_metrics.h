@@ -0,0 +1,78 @@
+#pragma once
+
+#include "linear_system.h"
+#include "variable_ordering.h"
+#include "solver_statistics.h"
+
+#include <string>
+
+/*
+	Cheap structural metrics of a linear system Px = r, used for choosing a solver backend.
+*/
+
+namespace linear_systems {
+
+	struct linear_system_metrics {
+		std::size_t size{ 0 };
+		std::size_t count_unresolved{ 0 };
+		std::size_t count_nonzeros{ 0 };
+		std::size_t count_sccs{ 0 }; // of the dependency graph of the unresolved variables
+		std::size_t count_nontrivial_sccs{ 0 }; // sccs with a cycle, self loops are part of the diagonal and do not count
+		std::size_t largest_scc{ 0 };
+		std::size_t max_numerator_bits{ 0 }; // of coefficients and right hand side
+		std::size_t max_denominator_bits{ 0 };
+	};
+
+	inline linear_system_metrics compute_linear_system_metrics(const matrix& P, const rational_vector& r, const id_vector& unresolved) {
+		linear_system_metrics metrics;
+		metrics.size = P.size();
+		metrics.count_unresolved = unresolved.size();
+
+		const auto update_bits = [&](const rational_type& value) {
+			metrics.max_numerator_bits = std::max(metrics.max_numerator_bits, bit_length(value.numerator()));
+			metrics.max_denominator_bits = std::max(metrics.max_denominator_bits, bit_length(value.denominator()));
+		};
+		for (var_id i{ 0 }; i < P.size(); ++i) {
+			metrics.count_nonzeros += P[i].size();
+			for (const auto& entry : P[i]) {
+				update_bits(entry.second);
+			}
+			update_bits(r[i]);
+		}
+
+		std::vector<bool> is_unresolved(P.size(), false);
+		for (const auto& v : unresolved) {
+			is_unresolved[v] = true;
+		}
+		const auto successors{ dependency_graph(P, is_unresolved) };
+		for (const auto& component : strongly_connected_components(successors, unresolved)) {
+			++metrics.count_sccs;
+			metrics.largest_scc = std::max(metrics.largest_scc, component.size());
+			if (component.size() > 1) {
+				++metrics.count_nontrivial_sccs;
+			}
+		}
+		return metrics;
+	}
+
+	/*
+		Rough bound for the bits of the denominators of the solution, like Hadamard's bound for the determinant of the largest strongly connected component:
+		its size times the bits of a coefficient. Acyclic systems get the bits of a coefficient only.
+	*/
+	inline std::size_t estimated_solution_bits(const linear_system_metrics& metrics) {
+		return std::max<std::size_t>(1, metrics.largest_scc) * (metrics.max_numerator_bits + metrics.max_denominator_bits);
+	}
+
+	inline std::string to_string(const linear_system_metrics& metrics) {
+		return std::string("size: ") + std::to_string(metrics.size) +
+			"   unresolved: " + std::to_string(metrics.count_unresolved) +
+			"   nonzeros: " + std::to_string(metrics.count_nonzeros) +
+			"   sccs: " + std::to_string(metrics.count_sccs) +
+			"   nontrivial sccs: " + std::to_string(metrics.count_nontrivial_sccs) +
+			"   largest scc: " + std::to_string(metrics.largest_scc) +
+			"   max numerator bits: " + std::to_string(metrics.max_numerator_bits) +
+			"   max denominator bits: " + std::to_string(metrics.max_denominator_bits) +
+			"   estimated solution bits: " + std::to_string(estimated_solution_bits(metrics));
+	}
+
+}
@@ -0,0 +1,286 @@
+#pragma once
+
+#include "linear_system.h"
+#include "linear_system_hybrid.h"
+#include "sparse_elimination.h"
+
+#include <cstdint>
+#include <future>
+#include <optional>
+#include <thread>
+#include <tuple>
+
+/*
+	Multi-modular solving:
+		1. scale every line of Px = r to integer coefficients,
+		2. solve the integer system modulo several word-size primes (independent, in parallel),
+		3. combine the residues by chinese remaindering and reconstruct rationals,
+		4. check Px = r exactly, add more primes if the check fails.
+	The reconstruction of all variables and the exact check are only tried once the reconstruction of a few sample variables
+	did not change by the last batch of primes, before that they would fail anyway.
+*/
+
+namespace linear_systems {
+
+	/*
+		Residue modulo a prime below 2^31, so that products fit into 64 bits.
+	*/
+	class modular_number {
+		std::uint64_t value;
+		std::uint64_t modulus;
+
+		modular_number inverse() const {
+			// Fermat: value^(p-2) == value^(-1)  (mod p)
+			std::uint64_t result{ 1 };
+			std::uint64_t base{ value };
+			for (std::uint64_t exponent{ modulus - 2 }; exponent > 0; exponent >>= 1) {
+				if (exponent & 1) {
+					result = (result * base) % modulus;
+				}
+				base = (base * base) % modulus;
+			}
+			return modular_number(result, modulus);
+		}
+
+	public:
+		modular_number() : value(0), modulus(0) {}
+		modular_number(std::uint64_t value, std::uint64_t modulus) : value(value), modulus(modulus) {}
+
+		std::uint64_t get() const { return value; }
+
+		modular_number operator+(const modular_number& other) const { return modular_number((value + other.value) % modulus, modulus); }
+		modular_number operator-(const modular_number& other) const { return modular_number((value + modulus - other.value) % modulus, modulus); }
+		modular_number operator*(const modular_number& other) const { return modular_number((value * other.value) % modulus, modulus); }
+		modular_number operator/(const modular_number& other) const { return *this * other.inverse(); }
+		modular_number operator-() const { return modular_number((modulus - value) % modulus, modulus); }
+		bool operator==(const modular_number& other) const { return value == other.value; }
+	};
+
+	inline bool is_zero(const modular_number& value) {
+		return value.get() == 0;
+	}
+
+	inline bool is_prime(std::uint64_t n) {
+		if (n < 2) return false;
+		if (n % 2 == 0) return n == 2;
+		for (std::uint64_t d{ 3 }; d * d <= n; d += 2) {
+			if (n % d == 0) return false;
+		}
+		return true;
+	}
+
+	/*
+		@return the next prime below p
+	*/
+	inline std::uint64_t previous_prime(std::uint64_t p) {
+		do {
+			--p;
+		} while (!is_prime(p));
+		return p;
+	}
+
+	inline constexpr std::uint64_t FIRST_MODULAR_SOLVER_PRIME{ 2147483647 }; // 2^31 - 1
+
+	inline std::uint64_t reduce_modulo(const big_int_type& value, std::uint64_t p) {
+		big_int_type remainder{ value % p };
+		if (remainder < 0) {
+			remainder += p;
+		}
+		return remainder.convert_to<std::uint64_t>();
+	}
+
+	/*
+		Every line i of P and r multiplied by the lcm of all denominators in that line.
+	*/
+	class integer_scaled_system {
+	public:
+		std::vector<std::vector<std::pair<var_id, big_int_type>>> A;
+		std::vector<big_int_type> b;
+
+		integer_scaled_system(const matrix& P, const rational_vector& r) : A(P.size()), b(P.size()) {
+			for (var_id i{ 0 }; i < P.size(); ++i) {
+				big_int_type line_lcm{ r[i].denominator() };
+				for (const auto& entry : P[i]) {
+					line_lcm = boost::multiprecision::lcm(line_lcm, entry.second.denominator());
+				}
+				A[i].reserve(P[i].size());
+				for (const auto& entry : P[i]) {
+					A[i].emplace_back(entry.first, entry.second.numerator() * (line_lcm / entry.second.denominator()));
+				}
+				b[i] = r[i].numerator() * (line_lcm / r[i].denominator());
+			}
+		}
+
+		/*
+			@return false if p is unlucky, i.e. the system is singular modulo p for the given elimination order.
+		*/
+		bool solve_modulo(std::uint64_t p, const id_vector& elimination_order, std::vector<std::uint64_t>& solution) const {
+			generic_matrix<modular_number> A_mod(A.size());
+			std::vector<modular_number> b_mod;
+			b_mod.reserve(b.size());
+			for (var_id i{ 0 }; i < A.size(); ++i) {
+				A_mod[i].reserve(A[i].size());
+				for (const auto& entry : A[i]) {
+					A_mod[i].emplace_back(entry.first, modular_number(reduce_modulo(entry.second, p), p));
+				}
+				b_mod.emplace_back(reduce_modulo(b[i], p), p);
+			}
+			if (!solve_linear_system_sparse_elimination(std::move(A_mod), b_mod, elimination_order)) {
+				return false;
+			}
+			solution.resize(b_mod.size());
+			std::transform(b_mod.cbegin(), b_mod.cend(), solution.begin(), [](const modular_number& x) { return x.get(); });
+			return true;
+		}
+	};
+
+	/*
+		Finds a/b with a == b * u (mod M) and |a|, b <= sqrt(M/2) by the extended euclidean algorithm.
+		@return false if there is no such fraction.
+	*/
+	inline bool reconstruct_rational_from_residue(const big_int_type& u, const big_int_type& M, rational_type& result) {
+		const big_int_type bound{ boost::multiprecision::sqrt(big_int_type(M / 2)) };
+		big_int_type r0{ M }, r1{ u };
+		big_int_type t0{ 0 }, t1{ 1 };
+		while (r1 > bound) {
+			const big_int_type q{ r0 / r1 };
+			big_int_type r2{ r0 - q * r1 };
+			big_int_type t2{ t0 - q * t1 };
+			r0 = std::move(r1);
+			r1 = std::move(r2);
+			t0 = std::move(t1);
+			t1 = std::move(t2);
+		}
+		if (t1 == 0 || boost::multiprecision::abs(t1) > bound || boost::multiprecision::gcd(t1, M) != 1) {
+			return false;
+		}
+		if (t1 < 0) { // rational_type does not accept negative denominators for unbounded integers
+			r1 = -r1;
+			t1 = -t1;
+		}
+		result = rational_type(r1, t1);
+		return true;
+	}
+
+	inline constexpr std::size_t MODULAR_SOLVER_STABILITY_SAMPLE_SIZE{ 8 };
+
+	/*
+		@return up to MODULAR_SOLVER_STABILITY_SAMPLE_SIZE variables spread over all, unresolved ones first since resolved ones are known early
+	*/
+	inline id_vector modular_stability_sample(const id_vector& unresolved, const id_vector& resolved) {
+		const id_vector& candidates{ unresolved.empty() ? resolved : unresolved };
+		const std::size_t count{ std::min(candidates.size(), MODULAR_SOLVER_STABILITY_SAMPLE_SIZE) };
+		id_vector sample;
+		for (std::size_t i{ 0 }; i < count; ++i) {
+			sample.push_back(candidates[i * candidates.size() / count]);
+		}
+		return sample;
+	}
+
+}
+
+/*
+	Same interface and result as solve_linear_system_dependency_order_optimized.
+	@param max_primes number of primes after which we give up and use solve_linear_system_dependency_order_optimized.
+*/
+inline void solve_linear_system_multi_modular(
+	linear_systems::matrix P,
+	linear_systems::rational_vector& r,
+	linear_systems::id_vector unresolved, // they have an external order. it should be kept.
+	linear_systems::id_vector resolved, // is not required to be ordered.
+	std::size_t max_primes = 4096
+) {
+	using namespace linear_systems;
+
+	const integer_scaled_system scaled(P, r);
+
+	id_vector elimination_order{ unresolved };
+	std::copy(resolved.cbegin(), resolved.cend(), std::back_inserter(elimination_order));
+
+	const std::size_t primes_per_round{ std::max<std::size_t>(4, std::thread::hardware_concurrency()) };
+
+	big_int_type modulus{ 1 };
+	std::vector<big_int_type> residues(P.size(), big_int_type(0));
+	std::uint64_t next_prime{ FIRST_MODULAR_SOLVER_PRIME };
+	std::size_t used_primes{ 0 };
+
+	const id_vector sample{ modular_stability_sample(unresolved, resolved) };
+	std::optional<rational_vector> sample_values; // reconstruction of the sample after the previous batch
+
+	while (used_primes < max_primes) {
+		// solve modulo a batch of primes in parallel:
+		std::vector<std::uint64_t> primes;
+		for (std::size_t i{ 0 }; i < primes_per_round; ++i) {
+			primes.push_back(next_prime);
+			next_prime = previous_prime(next_prime);
+		}
+		// the active statistics object belongs to this thread, so every worker counts into its own one, merged below:
+		const bool counting{ active_solver_statistics() != nullptr };
+		std::vector<std::future<std::tuple<bool, std::vector<std::uint64_t>, solver_statistics>>> the_futures;
+		for (const auto& p : primes) {
+			the_futures.emplace_back(std::async(std::launch::async, [&scaled, &elimination_order, p, counting]() {
+				solver_statistics worker_statistics;
+				solver_statistics_scope scope(counting ? &worker_statistics : nullptr);
+				std::vector<std::uint64_t> solution;
+				const bool lucky = scaled.solve_modulo(p, elimination_order, solution);
+				return std::make_tuple(lucky, std::move(solution), worker_statistics);
+				}));
+		}
+
+		// chinese remaindering: X' = X + M * ((x_p - X) * M^(-1) mod p)
+		for (std::size_t i{ 0 }; i < primes.size(); ++i) {
+			auto [lucky, solution, worker_statistics] = the_futures[i].get();
+			++used_primes;
+			if (auto statistics = active_solver_statistics()) {
+				++statistics->primes_used;
+				statistics->add(worker_statistics);
+			}
+			if (!lucky) {
+				if constexpr (feature_toggle::LINEAR_SYSTEMS_DEBUG_OUTPUT) {
+					standard_logger()->debug(std::string("Multi-modular solving: skipping unlucky prime ") + std::to_string(primes[i]));
+				}
+				continue;
+			}
+			const std::uint64_t p{ primes[i] };
+			const modular_number modulus_inverse{ modular_number(1, p) / modular_number(reduce_modulo(modulus, p), p) };
+			for (var_id v{ 0 }; v < residues.size(); ++v) {
+				const modular_number difference{ modular_number(solution[v], p) - modular_number(reduce_modulo(residues[v], p), p) };
+				residues[v] += modulus * (difference * modulus_inverse).get();
+			}
+			modulus *= p;
+		}
+
+		// cheap stability test before the full reconstruction:
+		rational_vector current_sample_values(sample.size());
+		bool sample_reconstructed{ true };
+		for (std::size_t i{ 0 }; i < sample.size() && sample_reconstructed; ++i) {
+			sample_reconstructed = reconstruct_rational_from_residue(residues[sample[i]], modulus, current_sample_values[i]);
+		}
+		if (!sample_reconstructed) {
+			sample_values.reset();
+			continue;
+		}
+		const bool stable{ sample_values == current_sample_values };
+		sample_values = std::move(current_sample_values);
+		if (!stable) {
+			continue;
+		}
+
+		// try to reconstruct and check the solution:
+		rational_vector x(P.size());
+		bool reconstructed{ true };
+		for (var_id v{ 0 }; v < residues.size() && reconstructed; ++v) {
+			reconstructed = reconstruct_rational_from_residue(residues[v], modulus, x[v]);
+		}
+		if (reconstructed && lines_violated_by(P, r, x, std::vector<bool>(P.size(), false)).empty()) {
+			if constexpr (feature_toggle::LINEAR_SYSTEMS_DEBUG_OUTPUT) {
+				standard_logger()->debug(std::string("Multi-modular solving: solved using ") + std::to_string(used_primes) + " primes.");
+			}
+			r = std::move(x);
+			return;
+		}
+	}
+
+	standard_logger()->warn(std::string("Multi-modular solving: no solution after ") + std::to_string(used_primes) + " primes, falling back to the dependency order solver.");
+	solve_linear_system_dependency_order_optimized(std::move(P), r, std::move(unresolved), std::move(resolved));
+}
@@ -0,0 +1,195 @@
+#pragma once
+
+#include "linear_system.h"
+#include "linear_system_hybrid.h"
+#include "linear_system_modular.h"
+#include "linear_system_incremental.h"
+#include "variable_ordering.h"
+#include "linear_system_metrics.h"
+
+#include <string>
+
+namespace linear_systems {
+
+	enum class solver_backend {
+		dependency_order,
+		hybrid_floating_point,
+		multi_modular,
+		incremental_low_rank, // only differs from an exact sparse elimination if used through an incremental_linear_system
+		automatic // one of the above chosen by select_solver_backend
+	};
+
+	inline std::string to_string(solver_backend backend) {
+		switch (backend) {
+		case solver_backend::dependency_order:
+			return "dependency-order";
+		case solver_backend::hybrid_floating_point:
+			return "hybrid";
+		case solver_backend::multi_modular:
+			return "multi-modular";
+		case solver_backend::incremental_low_rank:
+			return "incremental";
+		case solver_backend::automatic:
+			return "automatic";
+		}
+		return "unknown";
+	}
+
+	/*
+		The thresholds are meant to be tuned from benchmark data, so every decision should be logged together with the metrics.
+		They can be set by the task, see read_solver_selection_thresholds.
+	*/
+	struct solver_selection_thresholds {
+		std::size_t min_scc_for_modular{ 16 }; // smaller cycles are cheap for the dependency order solver ...
+		std::size_t min_solution_bits_for_modular{ 256 }; // ... unless their coefficients are large, see estimated_solution_bits
+		std::size_t max_solution_bits_for_hybrid{ 32 }; // such solutions are reconstructed from long double values reliably
+	};
+
+	/*
+		Acyclic systems are solved by dependency order elimination (no fill-in).
+		Cyclic systems whose solution is estimated to have small denominators go to the hybrid solver, its floating point values can be reconstructed.
+		On random models with 25 to 200 states the denominators were usually too large for that, hybrid solving was slower than dependency order elimination there.
+		Cyclic systems with large components or large coefficients go to the multi-modular solver, which does not suffer from intermediate coefficient growth.
+		Small cycles with small coefficients stay with dependency order elimination.
+	*/
+	inline solver_backend select_solver_backend(const linear_system_metrics& metrics, const solver_selection_thresholds& thresholds = solver_selection_thresholds()) {
+		if (metrics.count_nontrivial_sccs == 0) {
+			return solver_backend::dependency_order;
+		}
+		const std::size_t solution_bits{ estimated_solution_bits(metrics) };
+		if (solution_bits <= thresholds.max_solution_bits_for_hybrid) {
+			return solver_backend::hybrid_floating_point;
+		}
+		if (metrics.largest_scc >= thresholds.min_scc_for_modular || solution_bits >= thresholds.min_solution_bits_for_modular) {
+			return solver_backend::multi_modular;
+		}
+		return solver_backend::dependency_order;
+	}
+
+	struct solver_configuration {
+		solver_backend backend{ solver_backend::dependency_order };
+		bool backend_given{ false }; // by the task, otherwise a search may replace the default backend by a faster special one
+		variable_ordering ordering{ variable_ordering::scc_topological };
+		bool collect_statistics{ false }; // operation counters per policy iteration round, see solver_statistics
+		solver_selection_thresholds selection; // only used by solver_backend::automatic
+	};
+
+	inline std::string to_string(const solver_configuration& configuration) {
+		return to_string(configuration.backend) + "   with variable ordering:   " + to_string(configuration.ordering);
+	}
+
+}
+
+/*
+	Solves Px = r using the given backend, interface as for solve_linear_system_dependency_order_optimized.
+*/
+inline void solve_linear_system(
+	linear_systems::solver_backend backend,
+	linear_systems::matrix P,
+	linear_systems::rational_vector& r,
+	linear_systems::id_vector unresolved,
+	linear_systems::id_vector resolved,
+	const linear_systems::solver_selection_thresholds& thresholds = linear_systems::solver_selection_thresholds() // only used by solver_backend::automatic
+) {
+	switch (backend) {
+	case linear_systems::solver_backend::dependency_order:
+		return solve_linear_system_dependency_order_optimized(std::move(P), r, std::move(unresolved), std::move(resolved));
+	case linear_systems::solver_backend::hybrid_floating_point:
+		return solve_linear_system_hybrid_floating_point(std::move(P), r, std::move(unresolved), std::move(resolved));
+	case linear_systems::solver_backend::multi_modular:
+		return solve_linear_system_multi_modular(std::move(P), r, std::move(unresolved), std::move(resolved));
+	case linear_systems::solver_backend::incremental_low_rank:
+		return linear_systems::factorize_linear_system<rational_type>(P, unresolved, resolved).solve(r);
+	case linear_systems::solver_backend::automatic: {
+		const auto selected{ linear_systems::select_solver_backend(linear_systems::compute_linear_system_metrics(P, r, unresolved), thresholds) };
+		return solve_linear_system(selected, std::move(P), r, std::move(unresolved), std::move(resolved));
+	}
+	}
+}
+
+namespace linear_systems {
+
+	/*
+		@return all variables that some query variable depends on (transitively, including the queries) as a bit mask.
+	*/
+	inline std::vector<bool> dependency_cone(const matrix& P, const id_vector& query) {
+		std::vector<bool> in_cone(P.size(), false);
+		id_vector to_expand;
+		for (const auto& q : query) {
+			if (!in_cone[q]) {
+				in_cone[q] = true;
+				to_expand.push_back(q);
+			}
+		}
+		while (!to_expand.empty()) {
+			const var_id x{ to_expand.back() };
+			to_expand.pop_back();
+			for (const auto& entry : P[x]) {
+				if (!in_cone[entry.first] && entry.second != rational_type(0)) {
+					in_cone[entry.first] = true;
+					to_expand.push_back(entry.first);
+				}
+			}
+		}
+		return in_cone;
+	}
+
+}
+
+/*
+	Solves Px = r only for the variables the query variables depend on.
+	Interface as for solve_linear_system, but afterwards only the entries of r inside the dependency cone of query are valid.
+	When P comes from a scheduler, the cone of the initial state are the states reachable under this scheduler.
+*/
+inline void solve_linear_system_targeted(
+	linear_systems::solver_backend backend,
+	const linear_systems::matrix& P,
+	linear_systems::rational_vector& r,
+	const linear_systems::id_vector& unresolved,
+	const linear_systems::id_vector& resolved,
+	const linear_systems::id_vector& query,
+	const linear_systems::solver_selection_thresholds& thresholds = linear_systems::solver_selection_thresholds() // only used by solver_backend::automatic
+) {
+	using namespace linear_systems;
+
+	const std::vector<bool> in_cone{ dependency_cone(P, query) };
+	constexpr var_id NOT_IN_CONE{ std::numeric_limits<var_id>::max() };
+	id_vector new_id(P.size(), NOT_IN_CONE);
+	id_vector old_id;
+	for (var_id v{ 0 }; v < P.size(); ++v) {
+		if (in_cone[v]) {
+			new_id[v] = old_id.size();
+			old_id.push_back(v);
+		}
+	}
+	if (old_id.size() == P.size()) {
+		return solve_linear_system(backend, P, r, unresolved, resolved, thresholds);
+	}
+
+	matrix cone_P(old_id.size());
+	rational_vector cone_r(old_id.size());
+	for (var_id i{ 0 }; i < old_id.size(); ++i) {
+		cone_P[i].reserve(P[old_id[i]].size());
+		for (const auto& entry : P[old_id[i]]) {
+			if (in_cone[entry.first]) { // others have zero coefficients
+				cone_P[i].emplace_back(new_id[entry.first], entry.second);
+			}
+		}
+		cone_r[i] = r[old_id[i]];
+	}
+	const auto restrict_ids = [&](const id_vector& ids) {
+		id_vector restricted;
+		for (const auto& v : ids) {
+			if (in_cone[v]) {
+				restricted.push_back(new_id[v]);
+			}
+		}
+		return restricted;
+	};
+
+	solve_linear_system(backend, std::move(cone_P), cone_r, restrict_ids(unresolved), restrict_ids(resolved), thresholds);
+
+	for (var_id i{ 0 }; i < old_id.size(); ++i) {
+		r[old_id[i]] = std::move(cone_r[i]);
+	}
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "custom_types.h"
+
+#include <utility>
+#include <vector>
+
+namespace linear_systems {
+	using var_id = std::size_t;
+	using id_vector = std::vector<var_id>;
+	using rational_vector = std::vector<rational_type>;
+	using matrix_entry = std::pair<std::size_t, rational_type>;
+	using matrix_line = std::vector<matrix_entry>;
+	using matrix = std::vector<matrix_line>;
+}
@@ -1,7 +1,16 @@
 #include "logger.h"
 #include "utility.h"
 #include "linear_system.h"
+#include "linear_system_solver.h"
 #include "mdp_ops.h"
+#include "policy_model.h"
+#include "modified_policy_iteration.h"
+#include "interval_iteration.h"
+#include "negative_cycles.h"
+#include "qualitative_reachability.h"
+#include "end_components.h"
+#include "scheduler_enumeration.h"
+#include "hVar_search.h"
 #include "feature_toggle.h"
 
 #include <boost/multiprecision/cpp_int.hpp>
@@ -9,8 +18,11 @@
 
 #include <nlohmann/json.hpp>
 
+#include <atomic>
 #include <future>
+#include <optional>
 #include <random>
+#include <unordered_map>
 
 
 std::set<std::string> calc_reachable_states(const mdp& m) {
@@ -156,103 +168,232 @@ bool check_mdp_constraints_and_simplify(mdp& m) {
 
 
 
-std::size_t get_index(const std::vector<std::string>& str_vec, const std::string& s) {
-	for (std::size_t i{ 0 }; i < str_vec.size(); ++i) {
-		if (str_vec[i] == s) {
-			return i;
+/*
+	logs the chosen actions per state, on the original states if end components were collapsed
+*/
+void log_multi_scheduler(const scheduler_container& cont, const scheduler_container::multi_scheduler& s, const collapsed_end_components& collapsed) {
+	std::map<std::string, std::vector<std::string>> action_names;
+	for (const auto& decision : s) {
+		for (auto action_id : decision.second) {
+			action_names[decision.first].push_back(cont.available_actions_per_state.at(decision.first)[action_id]);
+		}
+	}
+	if (!collapsed.components.empty()) {
+		action_names = expand_optimal_actions(collapsed, action_names);
+	}
+	for (const auto& state_paired_actions : action_names) {
+		std::string schedulers_string;
+		for (const auto& action : state_paired_actions.second) {
+			schedulers_string += action + "   ";
+		}
+		standard_logger()->info(std::string("At state  ") + state_paired_actions.first + "  :  " + schedulers_string);
+	}
+}
+
+/*
+	logs one value per state, on the original states if end components were collapsed: every member has the value of its representative
+	@param values in the order of ordered_variables
+*/
+void log_values_per_state(const std::vector<std::string>& ordered_variables, const std::vector<std::string>& values, const collapsed_end_components& collapsed) {
+	if (collapsed.components.empty()) {
+		for (std::size_t i = 0; i < ordered_variables.size(); ++i) {
+			standard_logger()->info(std::string("At state  ") + ordered_variables[i] + "  :  " + values[i]);
 		}
+		return;
+	}
+	const state_index index{ make_state_index(ordered_variables) };
+	const auto representative_of{ representatives(collapsed.components) };
+	for (const auto& state : collapsed.original.states) {
+		const auto found{ representative_of.find(state) };
+		standard_logger()->info(std::string("At state  ") + state + "  :  " + values[get_index(index, found == representative_of.cend() ? state : found->second)]);
 	}
-	throw std::logic_error("String not contained in string vector.");
 }
 
+/*
+	Reports the result of interval iteration like optimize_scheduler, but all actions that may be optimal according to the bounds are listed
+	and every value is given by its lower and upper bound.
+	@return false if interval iteration is not applicable to m
+*/
+template <bool WRITE_LOG = true>
+bool optimize_scheduler_by_interval_iteration(const mdp& m, const std::vector<std::string>& ordered_variables, const linear_systems::solver_configuration& solver, const interval_iteration_configuration& configuration, const collapsed_end_components& collapsed) {
+	scheduler_container cont;
+	cont.init(m);
+	const dense_policy_model model(m, ordered_variables, cont);
 
-void create_matrix(const mdp& m, const std::vector<std::string>& ordered_variables, const scheduler_container& cont, linear_systems::matrix& mat, linear_systems::rational_vector& rew, linear_systems::id_vector& unresolved, linear_systems::id_vector& resolved) {
-
-	for (const auto& var : ordered_variables) {
-		const auto& line_var_id{ mat.size() };
-		if (cont.available_actions_per_state.at(var).empty()) { // it is a target state
-			rew.emplace_back(0);
-			linear_systems::matrix_line line = { { std::make_pair(line_var_id, rational_type(1)) } };
-			mat.emplace_back(std::move(line));
-		}
-		else { // it is no target state
-			const auto& action_id{ cont.sched.at(var) };
-			const auto action{ cont.available_actions_per_state.at(var)[action_id] };
-			rew.emplace_back(m.rewards.at(var).at(action));
-			linear_systems::matrix_line line;
-			bool extra_diagonal_entry{ true };
-			for (const auto& state_paired_rational : m.probabilities.at(var).at(action)) {
-				const auto& var_id{ get_index(ordered_variables, state_paired_rational.first) };
-				auto value{ state_paired_rational.second * rational_type(-1) };
-				if (var_id == line_var_id) {
-					value += rational_type(1);
-					extra_diagonal_entry = false;
-				}
-				line.push_back(std::make_pair(var_id, value));
-			}
-			if (extra_diagonal_entry) {
-				line.push_back(std::make_pair(line_var_id, 1));
-			}
-			mat.emplace_back(std::move(line));
-		}
-	}
-	// Px = rew
-	// target: xi = 0
-	// others: xj = Pk xk + r 
-	// .....->  (d_j - Pk) x = r
-	//
-
-	std::transform(
-		m.targets.begin(),
-		m.targets.end(),
-		std::back_inserter(resolved),
-		[&](const std::string& s) -> linear_systems::var_id { return get_index(ordered_variables, s); }
-	);
-	std::sort(resolved.begin(), resolved.end());
-
-	for (linear_systems::var_id i{ 0 }; i < mat.size(); ++i) {
-		unresolved.push_back(i);
-	}
-
-	auto new_end = std::copy_if(
-		unresolved.begin(),
-		unresolved.end(),
-		unresolved.begin(),
-		[&](const linear_systems::var_id& var) -> bool {
-			/* not contained in resolved */
-			auto found = std::lower_bound(resolved.cbegin(), resolved.cend(), var);
-			return found == resolved.cend() || *found != var;
-		}
-	);
-	unresolved.erase(new_end, unresolved.end());
+	interval_iteration_result<> result;
+	try {
+		result = interval_iteration(model, configuration, solver.ordering);
+	}
+	catch (const interval_iteration_error& e) {
+		if constexpr (WRITE_LOG) standard_logger()->warn(std::string(e.what()) + "   Continue with policy iteration.");
+		return false;
+	}
+	if constexpr (WRITE_LOG) standard_logger()->info(std::string("Interval iteration:   ") + std::to_string(result.sweeps) + " sweeps, maximal difference of bounds:   " + to_decimal_string(result.max_gap));
+	if (result.exact_max_gap > configuration.precision) {
+		if constexpr (WRITE_LOG) standard_logger()->warn(std::string("Interval iteration did not reach the requested precision, maximal difference of bounds:   ") + to_decimal_string(result.max_gap) + "   Continue with policy iteration.");
+		return false;
+	}
+
+	const auto candidates{ possibly_optimal_actions(model, result) };
+	scheduler_container::multi_scheduler s;
+	for (linear_systems::var_id var_id{ 0 }; var_id < model.count_states(); ++var_id) {
+		if (!candidates[var_id].empty()) {
+			s[ordered_variables[var_id]] = candidates[var_id];
+		}
+	}
+
+	if constexpr (WRITE_LOG) {
+		standard_logger()->info("The following memoryless deterministic scheduler(s) may be optimal, all others are not:");
+		log_multi_scheduler(cont, s, collapsed);
+		standard_logger()->info("The optimal expectations per state are within the following bounds:");
+		std::vector<std::string> bounds;
+		for (std::size_t i = 0; i < ordered_variables.size(); ++i) {
+			bounds.push_back(to_decimal_string(result.lower[i]) + "   " + to_decimal_string(result.upper[i]));
+		}
+		log_values_per_state(ordered_variables, bounds, collapsed);
+	}
+	return true;
 }
 
+/*
+	Removes all actions from cont.available_actions_per_state which cannot be optimal according to some cheap value bounds.
+	The bounds are the ones of interval iteration, but each strongly connected component gets a limited number of sweeps only.
+	They are verified exactly and an action is only removed if an exact comparison rules it out (see possibly_optimal_actions),
+	so the following exact policy iteration still finds all optimal schedulers.
+	cont.sched is reset to the first action everywhere.
+*/
 template <bool WRITE_LOG = true>
-void optimize_scheduler(mdp& m, const std::vector<std::string>& ordered_variables) { // do-check!
+void eliminate_suboptimal_actions(const mdp& m, const std::vector<std::string>& ordered_variables, scheduler_container& cont, linear_systems::variable_ordering ordering) {
+	interval_iteration_configuration configuration;
+	configuration.max_sweeps_per_component = 4096;
+
+	const dense_policy_model model(m, ordered_variables, cont);
+	interval_iteration_result<> bounds;
+	try {
+		bounds = interval_iteration(model, configuration, ordering);
+	}
+	catch (const interval_iteration_error& e) {
+		if constexpr (WRITE_LOG) standard_logger()->warn(std::string(e.what()) + "   No action elimination.");
+		return;
+	}
+	const auto candidates{ possibly_optimal_actions(model, bounds) };
+
+	std::size_t count_removed{ 0 };
+	for (linear_systems::var_id var_id{ 0 }; var_id < model.count_states(); ++var_id) {
+		if (model.count_actions(var_id) == 0 || candidates[var_id].size() == model.count_actions(var_id)) {
+			continue;
+		}
+		auto& actions{ cont.available_actions_per_state.at(ordered_variables[var_id]) };
+		std::vector<std::string> remaining;
+		for (const auto& action_id : candidates[var_id]) {
+			remaining.push_back(actions[action_id]);
+		}
+		count_removed += actions.size() - remaining.size();
+		actions = std::move(remaining);
+		cont.sched.at(ordered_variables[var_id]) = 0;
+	}
+	if constexpr (WRITE_LOG) standard_logger()->info(std::string("Action elimination:   removed ") + std::to_string(count_removed) + " of " + std::to_string(model.count_all_actions()) + " actions.");
+}
+
+/*
+	@param collapsed if m has collapsed end components, the results are reported on the original states
+*/
+template <bool WRITE_LOG = true>
+void optimize_scheduler(mdp& m, const std::vector<std::string>& ordered_variables, const linear_systems::solver_configuration& solver = linear_systems::solver_configuration(), const policy_iteration_configuration& policy_iteration = policy_iteration_configuration(), const interval_iteration_configuration& interval_iteration = interval_iteration_configuration(), const collapsed_end_components& collapsed = collapsed_end_components()) { // do-check!
+	if (interval_iteration.enabled && optimize_scheduler_by_interval_iteration<WRITE_LOG>(m, ordered_variables, solver, interval_iteration, collapsed)) {
+		return;
+	}
+
 	scheduler_container cont;
 
 
 	cont.init(m); // start with the "smallest" scheduler
 
+	if (policy_iteration.eliminate_actions) {
+		eliminate_suboptimal_actions<WRITE_LOG>(m, ordered_variables, cont, solver.ordering);
+	}
+
+	if (!policy_iteration.initial_actions.empty() || policy_iteration.reuse_previous_scheduler) {
+		auto initial_actions{ policy_iteration.initial_actions };
+		if (policy_iteration.reuse_previous_scheduler) {
+			initial_actions.merge(previous_scheduler::get()); // keeps the entries already there
+		}
+		const std::size_t count_chosen{ cont.choose_actions(initial_actions) };
+		if constexpr (WRITE_LOG) standard_logger()->info(std::string("Warm start:   initial action given for ") + std::to_string(count_chosen) + " of " + std::to_string(cont.sched.size()) + " states, the others start with their first action.");
+	}
+
+	const dense_policy_model model(m, ordered_variables, cont);
+	dense_policy_model::dense_scheduler decisions{ model.make_dense_scheduler(ordered_variables, cont) };
+	policy_matrix_builder builder(model, decisions); // lines are swapped for changed decisions only
+
+	bool certifying{ false }; // the first exact round checks the scheduler found by approximate evaluation
+	if (policy_iteration.evaluation != policy_evaluation::exact) {
+		const std::size_t approximate_rounds{ approximate_policy_iteration(model, builder, decisions, policy_iteration, solver.ordering) };
+		if constexpr (WRITE_LOG) standard_logger()->info(std::string("Modified policy iteration:   ") + std::to_string(approximate_rounds) + " approximate rounds, continue with exact policy iteration.");
+		certifying = true;
+	}
+
+	linear_systems::solver_backend backend{ solver.backend }; // solver_backend::automatic is replaced when seeing the first system
+	linear_systems::incremental_linear_system incremental; // only used by solver_backend::incremental_low_rank
+	linear_systems::id_vector changed_decisions;
+
+	// only used if solver.collect_statistics:
+	linear_systems::solver_statistics total_statistics;
+	std::vector<std::size_t> states_changed_per_round;
+
 	while (true) {
 
-		linear_systems::matrix mat;
-		linear_systems::rational_vector rew;
-		linear_systems::id_vector unresolved;
-		linear_systems::id_vector resolved;
+		linear_systems::rational_vector current_solution;
 
-		// create matrix
-		create_matrix(m, ordered_variables, cont, mat, rew, unresolved, resolved);
+		linear_systems::solver_statistics round_statistics;
+		const linear_systems::solver_statistics_scope statistics_scope(solver.collect_statistics ? &round_statistics : nullptr);
 
-		/*
-		for (const auto& decision : cont.sched) {
-			standard_logger()->trace(std::string("At state  ") + decision.first + "  :  " + cont.available_actions_per_state[decision.first][decision.second]);
+		if (backend == linear_systems::solver_backend::incremental_low_rank && incremental.is_factorized()) {
+			// only lines of states with a changed decision need to be updated
+			for (const auto& var_id : changed_decisions) {
+				incremental.replace_line(var_id, builder.line(var_id), builder.right_hand_side()[var_id]);
+			}
+			incremental.solve(current_solution);
 		}
-		*/
-		// solve matrix
-		solve_linear_system_dependency_order_optimized(mat, rew, unresolved, resolved);
+		else {
+			const linear_systems::matrix& mat{ builder.matrix() };
+			linear_systems::rational_vector rew{ builder.right_hand_side() };
+			linear_systems::id_vector unresolved{ builder.unresolved_variables(solver.ordering) };
+			const linear_systems::id_vector& resolved{ builder.resolved_variables() };
+
+			/*
+			for (const auto& decision : cont.sched) {
+				standard_logger()->trace(std::string("At state  ") + decision.first + "  :  " + cont.available_actions_per_state[decision.first][decision.second]);
+			}
+			*/
+			if (backend == linear_systems::solver_backend::automatic) {
+				const auto metrics{ linear_systems::compute_linear_system_metrics(mat, rew, unresolved) };
+				backend = linear_systems::select_solver_backend(metrics, solver.selection);
+				if constexpr (WRITE_LOG) standard_logger()->info(std::string("Solver selection:   ") + linear_systems::to_string(metrics) + "   -->>   " + linear_systems::to_string(backend));
+			}
 
-		linear_systems::rational_vector current_solution = rew;
+			// solve matrix
+			if (backend == linear_systems::solver_backend::incremental_low_rank) {
+				incremental.factorize(mat, std::move(rew), std::move(unresolved), resolved);
+				incremental.solve(current_solution);
+			}
+			else {
+				solve_linear_system(backend, mat, rew, unresolved, resolved);
+				current_solution = std::move(rew);
+			}
+		}
+		if (solver.collect_statistics) {
+			for (const auto& value : current_solution) {
+				round_statistics.record_coefficient(value);
+			}
+			total_statistics.add(round_statistics);
+			states_changed_per_round.push_back(changed_decisions.size());
+			nlohmann::json round_json = round_statistics.to_json(); // no braces, they would create a json array
+			round_json["round"] = states_changed_per_round.size();
+			round_json["states_changed"] = changed_decisions.size();
+			if constexpr (WRITE_LOG) standard_logger()->info(std::string("Solver statistics:   ") + round_json.dump());
+		}
+		changed_decisions.clear();
 
 		/*
 		for (std::size_t i = 0; i < current_solution.size(); ++i) {
@@ -261,79 +402,122 @@ void optimize_scheduler(mdp& m, const std::vector<std::string>& ordered_variable
 		}
 		*/
 
-		bool found_improvement{ false };
-
-		// improve the scheduler...
-		for (auto var = ordered_variables.cbegin(); var != ordered_variables.cend(); ++var) {
-			if (cont.available_actions_per_state[*var].empty()) { // no action to choose...
-				continue;
-			}
-			linear_systems::var_id var_id = var - ordered_variables.cbegin();
-			auto select_action = cont.sched[*var];
-			auto best_seen_value = current_solution[var_id];
-			for (auto action = cont.available_actions_per_state[*var].cbegin(); action != cont.available_actions_per_state[*var].cend(); ++action) {
-				std::size_t action_id = action - cont.available_actions_per_state[*var].cbegin();
-				auto& distr = m.probabilities[*var][*action];
-				rational_type accummulated{ m.rewards[*var][*action] };
-				for (const auto& state_paired_prob : distr) {
-					accummulated += state_paired_prob.second * current_solution[get_index(ordered_variables, state_paired_prob.first)];
+		// improve the scheduler, all states are independent of each other:
+		struct improvement_chunk {
+			bool found_improvement{ false };
+			linear_systems::id_vector changed_decisions;
+			std::vector<std::string> trace_messages; // logged after joining for keeping the log deterministic
+		};
+		const auto improvement_chunks = for_each_state_chunk(model.count_states(), [&](linear_systems::var_id begin, linear_systems::var_id end) {
+			improvement_chunk result;
+			for (linear_systems::var_id var_id{ begin }; var_id < end; ++var_id) {
+				if (model.count_actions(var_id) == 0) { // no action to choose...
+					continue;
+				}
+				auto select_action = decisions[var_id];
+				auto best_seen_value = current_solution[var_id];
+				for (std::size_t action_id{ 0 }; action_id < model.count_actions(var_id); ++action_id) {
+					rational_type accummulated{ model.action_value(var_id, action_id, current_solution) };
+					if (accummulated > best_seen_value) {
+						/*
+						standard_logger()->trace(std::string("improve valued from  ") +
+							best_seen_value.numerator().str() + "/" + best_seen_value.denominator().str() + "   to " +
+							accummulated.numerator().str() + "/" + accummulated.denominator().str());
+						*/
+						if constexpr (WRITE_LOG) {
+							const auto& actions{ cont.available_actions_per_state.at(ordered_variables[var_id]) };
+							result.trace_messages.push_back(std::string("improve decision at   ") + ordered_variables[var_id] + "   ::   " +
+								actions[select_action] + "   -->>   " + actions[action_id]
+								+ ":     " + best_seen_value.denominator().str());
+						}
+						select_action = action_id;
+						best_seen_value = accummulated;
+						result.found_improvement = true;
+					}
 				}
-				if (accummulated > best_seen_value) {
-					/*
-					standard_logger()->trace(std::string("improve valued from  ") +
-						best_seen_value.numerator().str() + "/" + best_seen_value.denominator().str() + "   to " +
-						accummulated.numerator().str() + "/" + accummulated.denominator().str());
-					*/
-					if constexpr (WRITE_LOG) standard_logger()->trace(std::string("improve decision at   ") + *var + "   ::   " +
-						cont.available_actions_per_state[*var][select_action] + "   -->>   " + cont.available_actions_per_state[*var][action_id]
-						+ ":     " + best_seen_value.denominator().str());
-					select_action = action_id;
-					best_seen_value = accummulated;
-					found_improvement = true;
+				if (decisions[var_id] != select_action) {
+					result.changed_decisions.push_back(var_id);
+					builder.change_decision(var_id, select_action); // only touches the line of var_id
 				}
+				decisions[var_id] = select_action;
 			}
-			cont.sched[*var] = select_action;
+			return result;
+			});
+
+		bool found_improvement{ false };
+		for (const auto& chunk : improvement_chunks) {
+			found_improvement = found_improvement || chunk.found_improvement;
+			std::copy(chunk.changed_decisions.cbegin(), chunk.changed_decisions.cend(), std::back_inserter(changed_decisions));
+			if constexpr (WRITE_LOG)
+				for (const auto& message : chunk.trace_messages) {
+					standard_logger()->trace(message);
+				}
+		}
+		if (certifying) {
+			if constexpr (WRITE_LOG) standard_logger()->info(found_improvement ?
+				std::string("Certification of the approximately optimal scheduler failed at ") + std::to_string(changed_decisions.size()) + " state(s), resume exact policy iteration." :
+				std::string("Certified the approximately optimal scheduler by one exact evaluation."));
+			certifying = false;
 		}
 
 		if (!found_improvement) {
 			// check for multiple optimal schedulers...
-			scheduler_container::multi_scheduler s;
-
-			for (auto var = ordered_variables.cbegin(); var != ordered_variables.cend(); ++var) {
-				if (cont.available_actions_per_state[*var].empty()) { // no action to choose...
-					continue;
-				}
-				linear_systems::var_id var_id = var - ordered_variables.cbegin();
-				auto best_seen_value = current_solution[var_id];
+			using optimal_actions = std::vector<std::pair<linear_systems::var_id, std::vector<std::size_t>>>;
+			const auto optimal_chunks = for_each_state_chunk(model.count_states(), [&](linear_systems::var_id begin, linear_systems::var_id end) {
+				optimal_actions result;
+				for (linear_systems::var_id var_id{ begin }; var_id < end; ++var_id) {
+					if (model.count_actions(var_id) == 0) { // no action to choose...
+						continue;
+					}
+					const auto& best_seen_value = current_solution[var_id];
 
-				//auto select_action = cont.sched[*var]; //?
-				for (auto action = cont.available_actions_per_state[*var].cbegin(); action != cont.available_actions_per_state[*var].cend(); ++action) {
-					std::size_t action_id = action - cont.available_actions_per_state[*var].cbegin();
-					auto& distr = m.probabilities[*var][*action];
-					rational_type accummulated{ m.rewards[*var][*action] };
-					for (const auto& state_paired_prob : distr) {
-						accummulated += state_paired_prob.second * current_solution[get_index(ordered_variables, state_paired_prob.first)];
+					std::vector<std::size_t> optimal;
+					for (std::size_t action_id{ 0 }; action_id < model.count_actions(var_id); ++action_id) {
+						if (model.action_value(var_id, action_id, current_solution) == best_seen_value) {
+							optimal.push_back(action_id);
+						}
 					}
-					if (accummulated == best_seen_value) {
-						s[*var].push_back(action_id);
+					if (!optimal.empty()) {
+						result.emplace_back(var_id, std::move(optimal));
 					}
 				}
+				return result;
+				});
+
+			scheduler_container::multi_scheduler s;
+			for (const auto& chunk : optimal_chunks) {
+				for (const auto& [var_id, optimal] : chunk) {
+					s[ordered_variables[var_id]] = optimal;
+				}
 			}
 
 			// output optimal schedulers
 			if constexpr (WRITE_LOG) standard_logger()->info("The following memoryless deterministic scheduler(s) is/are optimal:");
-			for (const auto& decision : s) {
-				std::string schedulers_string;
-				for (auto action_id : decision.second) {
-					schedulers_string += cont.available_actions_per_state[decision.first][action_id] + "   ";
+			if constexpr (WRITE_LOG) log_multi_scheduler(cont, s, collapsed);
+			if constexpr (WRITE_LOG) standard_logger()->info("The following expectations per state are optimal:");
+			if constexpr (WRITE_LOG) {
+				std::vector<std::string> values;
+				for (const auto& value : current_solution) {
+					values.push_back(value.numerator().str() + "/" + value.denominator().str());
 				}
-				if constexpr (WRITE_LOG) standard_logger()->info(std::string("At state  ") + decision.first + "  :  " + schedulers_string);
+				log_values_per_state(ordered_variables, values, collapsed);
 			}
-			if constexpr (WRITE_LOG) standard_logger()->info("The following expectations per state are optimal:");
-			if constexpr (WRITE_LOG)
-				for (std::size_t i = 0; i < current_solution.size(); ++i) {
-					standard_logger()->info(std::string("At state  ") + ordered_variables[i] + "  :  " + current_solution[i].numerator().str() + "/" + current_solution[i].denominator().str());
+			if (policy_iteration.reuse_previous_scheduler) {
+				std::map<std::string, std::string> optimal_actions;
+				for (linear_systems::var_id var_id{ 0 }; var_id < model.count_states(); ++var_id) {
+					if (model.count_actions(var_id) != 0) {
+						optimal_actions[ordered_variables[var_id]] = cont.available_actions_per_state.at(ordered_variables[var_id])[decisions[var_id]];
+					}
 				}
+				previous_scheduler::set(std::move(optimal_actions));
+			}
+			if (solver.collect_statistics) {
+				nlohmann::json summary;
+				summary["rounds"] = states_changed_per_round.size();
+				summary["states_changed_per_round"] = states_changed_per_round;
+				summary["total"] = total_statistics.to_json();
+				if constexpr (WRITE_LOG) standard_logger()->info(std::string("Solver statistics summary:   ") + summary.dump());
+			}
 			return;
 		}
 		if constexpr (WRITE_LOG) standard_logger()->info("Found a scheduler improvement. Rerun stepwise improvement.");
@@ -393,65 +577,213 @@ void check_task_okay(const nlohmann::json& merged_json) { // do-check!
 
 }
 
+/**
+*	reads the optional solver selection inside task.calc, defaults to the dependency order solver
+*/
+linear_systems::solver_backend read_solver_backend(const nlohmann::json& calc_json) {
+	if (!calc_json.contains(keywords::solvers::solver)) {
+		return linear_systems::solver_backend::dependency_order;
+	}
+	json_task_error::check("calc_solver_is_string", calc_json.at(keywords::solvers::solver).is_string());
+	const auto solver_name{ calc_json.at(keywords::solvers::solver).get<std::string>() };
+	if (solver_name == keywords::solvers::dependency_order) {
+		return linear_systems::solver_backend::dependency_order;
+	}
+	if (solver_name == keywords::solvers::hybrid) {
+		return linear_systems::solver_backend::hybrid_floating_point;
+	}
+	if (solver_name == keywords::solvers::multi_modular) {
+		return linear_systems::solver_backend::multi_modular;
+	}
+	if (solver_name == keywords::solvers::incremental) {
+		return linear_systems::solver_backend::incremental_low_rank;
+	}
+	if (solver_name == keywords::solvers::automatic) {
+		return linear_systems::solver_backend::automatic;
+	}
+	throw json_task_error(std::string("calc_solver_is_unknown:   ") + solver_name);
+}
+
+/**
+*	reads the optional thresholds for the automatic solver selection inside task.calc, defaults as in solver_selection_thresholds
+*/
+linear_systems::solver_selection_thresholds read_solver_selection_thresholds(const nlohmann::json& calc_json) {
+	linear_systems::solver_selection_thresholds thresholds;
+	if (!calc_json.contains(keywords::solvers::selection)) {
+		return thresholds;
+	}
+	const nlohmann::json& selection_json{ calc_json.at(keywords::solvers::selection) };
+	json_task_error::check("calc_solver_selection_is_object", selection_json.is_object());
+	const auto read_threshold = [&](const std::string_view& key, std::size_t& threshold) {
+		if (selection_json.contains(key)) {
+			json_task_error::check(std::string("calc_solver_selection_threshold_is_unsigned_integer:   ") + std::string(key), selection_json.at(key).is_number_unsigned());
+			threshold = selection_json.at(key).get<std::size_t>();
+		}
+	};
+	read_threshold(keywords::solvers::min_scc_for_modular, thresholds.min_scc_for_modular);
+	read_threshold(keywords::solvers::min_solution_bits_for_modular, thresholds.min_solution_bits_for_modular);
+	read_threshold(keywords::solvers::max_solution_bits_for_hybrid, thresholds.max_solution_bits_for_hybrid);
+	return thresholds;
+}
+
+/**
+*	reads the optional variable ordering inside task.calc, defaults to strongly connected components in topological order
+*/
+linear_systems::variable_ordering read_variable_ordering(const nlohmann::json& calc_json) {
+	if (!calc_json.contains(keywords::solvers::ordering)) {
+		return linear_systems::variable_ordering::scc_topological;
+	}
+	json_task_error::check("calc_ordering_is_string", calc_json.at(keywords::solvers::ordering).is_string());
+	const auto ordering_name{ calc_json.at(keywords::solvers::ordering).get<std::string>() };
+	if (ordering_name == keywords::solvers::discovery) {
+		return linear_systems::variable_ordering::discovery;
+	}
+	if (ordering_name == keywords::solvers::scc_topological) {
+		return linear_systems::variable_ordering::scc_topological;
+	}
+	if (ordering_name == keywords::solvers::minimum_degree) {
+		return linear_systems::variable_ordering::minimum_degree;
+	}
+	throw json_task_error(std::string("calc_ordering_is_unknown:   ") + ordering_name);
+}
+
+/**
+*	reads the optional policy evaluation and warm start inside task.calc, defaults to exact evaluation only starting from the first action everywhere
+*/
+policy_iteration_configuration read_policy_iteration_configuration(const nlohmann::json& calc_json) {
+	policy_iteration_configuration configuration;
+	if (calc_json.contains(keywords::policy_iteration::sweeps)) {
+		json_task_error::check("calc_sweeps_is_positive_integer", calc_json.at(keywords::policy_iteration::sweeps).is_number_unsigned() && calc_json.at(keywords::policy_iteration::sweeps).get<std::size_t>() > 0);
+		configuration.sweeps = calc_json.at(keywords::policy_iteration::sweeps).get<std::size_t>();
+	}
+	if (calc_json.contains(keywords::policy_iteration::initial_scheduler)) {
+		nlohmann::json initial_scheduler = calc_json.at(keywords::policy_iteration::initial_scheduler);
+		if (initial_scheduler.is_string()) { // a file name
+			const auto file_name{ initial_scheduler.get<std::string>() };
+			initial_scheduler = load_json(file_name, nlohmann::json());
+			json_task_error::check(std::string("calc_initial_scheduler_file_is_not_valid:   ") + file_name, initial_scheduler.is_object());
+		}
+		json_task_error::check("calc_initial_scheduler_is_object_or_file_name", initial_scheduler.is_object());
+		for (auto iter = initial_scheduler.cbegin(); iter != initial_scheduler.cend(); ++iter) {
+			json_task_error::check(std::string("calc_initial_scheduler_action_is_string:   ") + iter.key(), iter.value().is_string());
+			configuration.initial_actions[iter.key()] = iter.value().get<std::string>();
+		}
+	}
+	if (calc_json.contains(keywords::policy_iteration::action_elimination)) {
+		json_task_error::check("calc_action_elimination_is_boolean", calc_json.at(keywords::policy_iteration::action_elimination).is_boolean());
+		configuration.eliminate_actions = calc_json.at(keywords::policy_iteration::action_elimination).get<bool>();
+	}
+	if (calc_json.contains(keywords::policy_iteration::reuse_previous_scheduler)) {
+		json_task_error::check("calc_reuse_previous_scheduler_is_boolean", calc_json.at(keywords::policy_iteration::reuse_previous_scheduler).is_boolean());
+		configuration.reuse_previous_scheduler = calc_json.at(keywords::policy_iteration::reuse_previous_scheduler).get<bool>();
+	}
+	if (!calc_json.contains(keywords::policy_iteration::evaluation)) {
+		return configuration;
+	}
+	json_task_error::check("calc_evaluation_is_string", calc_json.at(keywords::policy_iteration::evaluation).is_string());
+	const auto evaluation_name{ calc_json.at(keywords::policy_iteration::evaluation).get<std::string>() };
+	if (evaluation_name == keywords::policy_iteration::exact) {
+		configuration.evaluation = policy_evaluation::exact;
+	}
+	else if (evaluation_name == keywords::policy_iteration::sweeps) {
+		configuration.evaluation = policy_evaluation::sweeps;
+	}
+	else if (evaluation_name == keywords::policy_iteration::floating_point) {
+		configuration.evaluation = policy_evaluation::floating_point;
+	}
+	else {
+		throw json_task_error(std::string("calc_evaluation_is_unknown:   ") + evaluation_name);
+	}
+	return configuration;
+}
+
+/**
+*	reads the optional algorithm inside task.calc, defaults to policy iteration, the precision is only used by interval iteration
+*/
+interval_iteration_configuration read_interval_iteration_configuration(const nlohmann::json& calc_json) {
+	interval_iteration_configuration configuration;
+	if (calc_json.contains(keywords::algorithms::precision)) {
+		json_task_error::check("calc_precision_is_string", calc_json.at(keywords::algorithms::precision).is_string());
+		try {
+			configuration.precision = string_to_rational_type(calc_json.at(keywords::algorithms::precision).get<std::string>());
+		}
+		catch (const rational_parse_error& e) {
+			throw json_task_error(std::string("calc_precision_is_not_a_rational:   ") + e.what());
+		}
+		json_task_error::check("calc_precision_is_positive", configuration.precision > rational_type(0));
+	}
+	if (!calc_json.contains(keywords::algorithms::algorithm)) {
+		return configuration;
+	}
+	json_task_error::check("calc_algorithm_is_string", calc_json.at(keywords::algorithms::algorithm).is_string());
+	const auto algorithm_name{ calc_json.at(keywords::algorithms::algorithm).get<std::string>() };
+	if (algorithm_name == keywords::algorithms::policy_iteration) {
+		configuration.enabled = false;
+	}
+	else if (algorithm_name == keywords::algorithms::interval_iteration) {
+		configuration.enabled = true;
+	}
+	else {
+		throw json_task_error(std::string("calc_algorithm_is_unknown:   ") + algorithm_name);
+	}
+	return configuration;
+}
+
 /**
 *	removes unreachable states, throws error if error_on_exists_unreachable_state
 */
 template <bool WRITE_LOG = true>
 void remove_unreachable_states(mdp& m, bool error_on_exists_unreachable_state) { // do-check!
-	std::string& initial_state{ m.initial };
-
-	std::vector<std::string> reachables;
-	reachables.push_back(initial_state);
-
-	std::size_t next_expand{ 0 };
+	// breadth first search over state ids, states are numbered in the order of m.states, states not in m.states get ids behind:
+	std::unordered_map<std::string, std::size_t> index;
+	index.reserve(m.states.size());
+	std::vector<const std::string*> names;
+	names.reserve(m.states.size());
+	for (const auto& state : m.states) {
+		index.emplace(state, names.size());
+		names.push_back(&state);
+	}
+	std::vector<bool> reached(names.size(), false);
+	const auto reach = [&](const std::string& state) -> std::optional<std::size_t> {
+		const auto [found, inserted] = index.emplace(state, names.size());
+		if (inserted) { //## this is an internal error
+			names.push_back(&found->first);
+			reached.push_back(false);
+		}
+		if (reached[found->second]) {
+			return std::nullopt;
+		}
+		reached[found->second] = true;
+		return found->second;
+	};
 
-	while (next_expand < reachables.size()) {
-		auto& actions_paired_distr{ m.probabilities[reachables[next_expand]] };
+	std::vector<std::size_t> queue;
+	queue.push_back(*reach(m.initial));
+	for (std::size_t next_expand{ 0 }; next_expand < queue.size(); ++next_expand) {
+		auto& actions_paired_distr{ m.probabilities[*names[queue[next_expand]]] };
 		for (auto& action_paired_distr : actions_paired_distr) {
-		again_inner_loop:
-			for (auto next_state_paired_probability = action_paired_distr.second.begin(); next_state_paired_probability != action_paired_distr.second.end(); ++next_state_paired_probability) {
-				if (next_state_paired_probability->second != rational_type(0)) {
-					auto& next_s{ next_state_paired_probability->first };
-					auto found = std::find(
-						reachables.cbegin(),
-						reachables.cend(),
-						next_s
-					);
-					if (found == reachables.cend()) {
-						reachables.push_back(next_s);
-					}
-				}
-				else {
+			auto& distr{ action_paired_distr.second };
+			for (auto next_state_paired_probability = distr.begin(); next_state_paired_probability != distr.end();) {
+				if (next_state_paired_probability->second == rational_type(0)) {
 					///#### log that a zero prob- transition was found
-					action_paired_distr.second.erase(next_state_paired_probability);
-					goto again_inner_loop; // because of iterator invalidation!!!
+					next_state_paired_probability = distr.erase(next_state_paired_probability);
+					continue;
+				}
+				if (const auto id{ reach(next_state_paired_probability->first) }) {
+					queue.push_back(*id);
 				}
+				++next_state_paired_probability;
 			}
 		}
-		++next_expand;
 	}
 
 	std::vector<std::string> unreachables;
-
-	std::sort(reachables.begin(), reachables.end());
-	auto iter = reachables.cbegin();
-	for (const auto& state : m.states) {
-		if (iter == reachables.cend()) {
-			unreachables.push_back(state);
-			continue;
-		}
-		if (state == *iter) {
-			++iter;
-			continue;
-		}
-		if (state < *iter) {
-			unreachables.push_back(state);
-			continue;
-		}
-		if (*iter < state) {
-			++iter;
-			//## this is an internal error
-			continue;
+	{
+		std::size_t id{ 0 };
+		for (const auto& state : m.states) {
+			if (!reached[id++]) {
+				unreachables.push_back(state);
+			}
 		}
 	}
 	if (!unreachables.empty()) {
@@ -471,52 +803,25 @@ void remove_unreachable_states(mdp& m, bool error_on_exists_unreachable_state) {
 
 	// remove the unreachable states:
 	for (const auto& state : unreachables) {
-		m.states.erase(state);
 		m.targets.erase(state);
 		m.probabilities.erase(state); // next states already removed:: either probability 0 or exists only on right side of another unreachable state
 		m.rewards.erase(state);
 	}
+	std::size_t id{ 0 };
+	for (auto state = m.states.begin(); state != m.states.end();) {
+		state = reached[id++] ? std::next(state) : m.states.erase(state);
+	}
 }
 
 template <bool WRITE_LOG = true>
-bool check_reaching_target_is_guaranteed(mdp& m) { // do-check!
-	std::map<std::string, bool> prob_to_target_is_positive;
-	std::map<std::string, bool> is_target;
-	for (const auto& state : m.states) {
-		prob_to_target_is_positive[state] = false;
-	}
-	for (const auto& state : m.targets) {
-		prob_to_target_is_positive[state] = true;
-	}
-	is_target = prob_to_target_is_positive;
-
-	bool has_changes{ true };
-	while (has_changes) {
-		has_changes = false;
-
-		for (auto& pair : prob_to_target_is_positive) {
-			if (pair.second == true)
-				continue;
-			const bool update = std::accumulate(
-				m.probabilities.at(pair.first).cbegin(),
-				m.probabilities.at(pair.first).cend(),
-				!m.probabilities.at(pair.first).empty(),
-				[&](bool b, const std::map<std::string, std::map<std::string, rational_type>>::const_iterator::value_type& action_paired_distr) -> bool {
-					return b && std::accumulate(action_paired_distr.second.cbegin(), action_paired_distr.second.cend(), false,
-						[&](bool inner_b, const std::pair<std::string, rational_type>& next_state_prob) {
-							return inner_b || prob_to_target_is_positive[next_state_prob.first];
-						});
-				}
-			);
-			if (update)
-				has_changes = true;
-			pair.second = update;
-		}
-	}
+bool check_reaching_target_is_guaranteed(const mdp& m) { // do-check!
+	// every scheduler has to reach some target with positive probability from every state, i.e. prob0E has to be empty
+	const std::vector<bool> can_miss_target{ prob0E(make_qualitative_graph(m), target_flags(m)) };
 	bool found_error{ false };
-	for (const auto& pair : prob_to_target_is_positive) {
-		if (pair.second == false) {
-			if constexpr (WRITE_LOG) standard_logger()->error(std::string("Found a state from which you cannot reach a target:   ") + pair.first);
+	std::size_t id{ 0 };
+	for (const auto& state : m.states) {
+		if (can_miss_target[id++]) {
+			if constexpr (WRITE_LOG) standard_logger()->error(std::string("Found a state from which you cannot reach a target:   ") + state);
 			found_error = true;
 		}
 	}
@@ -710,127 +1015,6 @@ std::pair<mdp, bool> generate_mdp(std::size_t count_states, std::size_t count_ta
 	return std::make_pair(m, resolve_nondeterminism > 0);
 }
 
-std::tuple<rational_type, std::vector <rational_type>, std::vector<scheduler_container>> check_all_exponential_schedulers_for_hVar(const mdp& m, const mdp& first_unfolded_with_normal_rewwards, const rational_type& lambda, const rational_type& cut_level, const std::vector<std::string>& ordered_variables) {
-
-	scheduler_container cont;
-
-	rational_type best_seen_result;
-	std::vector <rational_type> mu_for_best_seen_result;
-	std::vector<scheduler_container> best_seen_scheduler;
-	bool first_result_found{ false };
-	std::mutex access_optimal_values;
-
-	//std::list<std::thread> threads;
-	std::list<std::future<void>> the_futures;
-
-	cont.init(first_unfolded_with_normal_rewwards);
-
-	auto size_message = std::string("number of schedulers to be tested:   ") + cont.number_of_schedulers().numerator().str();
-	standard_logger()->trace(size_message);
-	do {
-		//const scheduler_container& cont_const_ref{ cont };
-
-		auto evaluate_one_scheduler = [&first_unfolded_with_normal_rewwards, &ordered_variables, &lambda, &m, &cut_level, &first_result_found, &best_seen_result, &mu_for_best_seen_result, &best_seen_scheduler, &access_optimal_values](const scheduler_container cont_const_ref) { //  
-
-			// to be filled in...
-			linear_systems::matrix mat;
-			linear_systems::rational_vector rew;
-			linear_systems::id_vector unresolved;
-			linear_systems::id_vector resolved;
-
-			// create matrix
-			create_matrix(first_unfolded_with_normal_rewwards, ordered_variables, cont_const_ref, mat, rew, unresolved, resolved);
-
-
-			// solve matrix
-			solve_linear_system_dependency_order_optimized(mat, rew, unresolved, resolved);
-
-			// we have mu for classical problem so far
-			linear_systems::rational_vector current_solution = rew;
-
-			std::size_t index_of_initial_state = std::find(ordered_variables.cbegin(), ordered_variables.cend(), first_unfolded_with_normal_rewwards.initial) - ordered_variables.cbegin(); // initial state should be the first one, so == 0
-			if (index_of_initial_state != 0) {
-				standard_logger()->error("Internal error: exp-sched-index-of-initial-state");
-			}
-			rational_type current_mu = current_solution[index_of_initial_state];
-
-			const auto modify{
-				[&](const rational_type& arg) {
-					return arg - lambda * std::max(rational_type(0), current_mu) * std::max(rational_type(0), current_mu);
-				}
-			};
-
-			// now modify the rewards in m, so we can calculat ethe actual mu - \lambda hVar.
-
-			mdp unfolded_cut_with_modified_rewards;
-
-			std::vector<std::string> modified_ordered_variables;
-
-			scheduler_container cont2 = cont_const_ref;
-
-			unfolded_cut_with_modified_rewards = modified_stupid_unfold(m, cut_level, modified_ordered_variables, modify, cont2);
-			{
-				// to be filled in...
-				linear_systems::matrix mat2;
-				linear_systems::rational_vector rew2;
-				linear_systems::id_vector unresolved2;
-				linear_systems::id_vector resolved2;
-
-				// create matrix
-				create_matrix(unfolded_cut_with_modified_rewards, modified_ordered_variables, cont2, mat2, rew2, unresolved2, resolved2);
-
-
-				// solve matrix
-				solve_linear_system_dependency_order_optimized(mat2, rew2, unresolved2, resolved2);
-
-				// we have mu for classical problem so far
-				linear_systems::rational_vector current_solution_with_hVar = rew2;
-
-				std::size_t index_of_initial_state2 = std::find(modified_ordered_variables.cbegin(), modified_ordered_variables.cend(), unfolded_cut_with_modified_rewards.initial) - modified_ordered_variables.cbegin(); // initial state should be the first one, so == 0
-				rational_type current_mu_minus_hVar = current_solution_with_hVar[index_of_initial_state2];
-
-				const auto lock_access = std::lock_guard<std::mutex>(access_optimal_values);
-
-				if (!first_result_found || current_mu_minus_hVar > best_seen_result) {
-					first_result_found = true;
-					best_seen_result = current_mu_minus_hVar;
-					mu_for_best_seen_result.clear();
-					best_seen_scheduler.clear();
-				}
-				if (current_mu_minus_hVar == best_seen_result) {
-					mu_for_best_seen_result.push_back(current_mu);
-					best_seen_scheduler.push_back(cont_const_ref);
-
-				}
-			}
-		};
-
-		if (!(the_futures.size() < feature_toggle::COUNT_THREADS)) {
-			while (true) {
-				for (auto iter = the_futures.begin(); iter != the_futures.end(); ++iter) {
-					if (iter->wait_for(std::chrono::milliseconds(0)) == std::future_status::ready) {
-						iter->wait();
-						the_futures.erase(iter); // iterator invalidation!
-						goto continue_6248974735;
-					}
-				}
-				std::this_thread::sleep_for(std::chrono::milliseconds(10));
-			}
-		}
-	continue_6248974735:
-
-		//threads.push_back(std::thread(evaluate_one_scheduler, cont));
-		the_futures.emplace_back(std::async(std::launch::async, evaluate_one_scheduler, cont));
-
-	} while (cont.operator++());
-
-	for (auto& f : the_futures) {
-		f.wait();
-	}
-
-	return std::make_tuple(best_seen_result, mu_for_best_seen_result, best_seen_scheduler);
-}
-
 std::size_t number_of_steps_in_mdp_to_reach_goal_with_at_least(const mdp& m, rational_type probability) {
 	std::map<std::string, std::vector<rational_type>> states_to_min_probabilities; // state s |-> [p0, p1, p2, p3, p4, ... ]
 		// p_i is the minimum probability to reach a goal state t for the first time after  i steps or even earlier.
@@ -906,6 +1090,48 @@ rational_type maximal_weight_after_n_steps(const mdp& m, std::size_t n_steps) {
 		});
 }
 
+/*
+	Analyses of the pruned mdp. They only read m and do not depend on each other, so they run concurrently on the same const snapshot:
+		stage 1: reaching the target is guaranteed (if check_reaching_target),
+		stage 2: no negative loop (if check_no_negative_cycles) and delta max.
+	The reported error is the one of the first failing stage, as if the stages ran in sequence:
+	a failing stage cancels the later ones, the earlier ones are always finished.
+	@return 0 if all analyses passed, otherwise the application error code, which is logged already
+*/
+std::size_t analyse_pruned_mdp(const mdp& m, bool check_reaching_target, bool check_no_negative_cycles, bool ignore_negative_cycles_on_target_states, std::map<std::string, rational_type>& delta_max) {
+	std::atomic<bool> cancel_delta_max{ false };
+	auto delta_max_stage = std::async(std::launch::async, [&]() {
+		if (check_no_negative_cycles) {
+			check_no_negative_cycle(m, ignore_negative_cycles_on_target_states, &cancel_delta_max);
+		}
+		return calc_delta_max_state_wise(m, ignore_negative_cycles_on_target_states, check_no_negative_cycles, &cancel_delta_max);
+		});
+
+	if (check_reaching_target && !check_reaching_target_is_guaranteed(m)) {
+		cancel_delta_max = true;
+		delta_max_stage.wait(); // its result or exception does not matter anymore
+		const std::size_t error_code{ 10 };
+		standard_logger()->error(application_errors::application_error_messages[error_code].data());
+		return error_code;
+	}
+
+	try {
+		delta_max = delta_max_stage.get();
+	}
+	catch (const found_negative_loop& e) {
+		standard_logger()->error(e.what());
+		const std::size_t error_code{ 6 };
+		standard_logger()->error(application_errors::application_error_messages[error_code].data());
+		return error_code;
+	}
+	catch (const calc_delta_max_error& e) {
+		standard_logger()->error(e.what());
+		const std::size_t error_code{ 7 };
+		standard_logger()->error(application_errors::application_error_messages[error_code].data());
+		return error_code;
+	}
+	return 0;
+}
 
 int run_starting_from_merged_json(const nlohmann::json& merged_json) { // do-check!, ready but enhance the different cases -> common steps before might be inappropriate for other options
 	standard_logger()->info("Checking for validness of MDP (json -> MDP)...");
@@ -977,38 +1203,59 @@ int run_starting_from_merged_json(const nlohmann::json& merged_json) { // do-che
 	if (!task_checks_reaching_target_with_probability_1) {
 		standard_logger()->warn("Skipping reachable target check!");
 	}
-	else {
-		if (!check_reaching_target_is_guaranteed(m)) {
-			const std::size_t error_code{ 10 };
-			standard_logger()->error(application_errors::application_error_messages[error_code].data());
-			return error_code;
-		}
-	}
 
 	std::map<std::string, rational_type> delta_max;
+	if (const std::size_t error_code{ analyse_pruned_mdp(m, task_checks_reaching_target_with_probability_1, task_checks_no_negative_cycles, task_checks_ignore_negative_cycles_on_target_states, delta_max) }) {
+		return error_code;
+	}
+
+	auto& calc_json{ merged_json.at(keywords::task).at(keywords::calc) };
+
+	linear_systems::solver_configuration solver;
+	policy_iteration_configuration policy_iteration;
+	interval_iteration_configuration interval_iteration;
 	try {
-		delta_max = calc_delta_max_state_wise(m, task_checks_ignore_negative_cycles_on_target_states, task_checks_no_negative_cycles);
+		solver.backend = read_solver_backend(calc_json);
+		solver.backend_given = calc_json.contains(keywords::solvers::solver);
+		solver.selection = read_solver_selection_thresholds(calc_json);
+		solver.ordering = read_variable_ordering(calc_json);
+		if (calc_json.contains(keywords::solvers::statistics)) {
+			json_task_error::check("calc_statistics_is_boolean", calc_json.at(keywords::solvers::statistics).is_boolean());
+			solver.collect_statistics = calc_json.at(keywords::solvers::statistics).get<bool>();
+		}
+		policy_iteration = read_policy_iteration_configuration(calc_json);
+		interval_iteration = read_interval_iteration_configuration(calc_json);
 	}
-	catch (const found_negative_loop& e) {
+	catch (const json_task_error& e) {
 		standard_logger()->error(e.what());
-		const std::size_t error_code{ 6 };
+		const std::size_t error_code{ 8 };
 		standard_logger()->error(application_errors::application_error_messages[error_code].data());
 		return error_code;
 	}
-	catch (const calc_delta_max_error& e) {
-		standard_logger()->error(e.what());
-		const std::size_t error_code{ 7 };
-		standard_logger()->error(application_errors::application_error_messages[error_code].data());
-		return error_code;
+	standard_logger()->info(std::string("Using linear system solver:   ") + linear_systems::to_string(solver));
+	if (interval_iteration.enabled) {
+		standard_logger()->info(std::string("Using interval iteration with precision:   ") + interval_iteration.precision.numerator().str() + "/" + interval_iteration.precision.denominator().str());
 	}
-
-	auto& calc_json{ merged_json.at(keywords::task).at(keywords::calc) };
+	standard_logger()->info(std::string("Using policy evaluation:   ") + to_string(policy_iteration));
 	if (calc_json.at(keywords::mode).get<std::string>() == keywords::value::classic.data()) { // classical SSP-Problem
 
+		// after the analyses, which have to see the original mdp, and only here, where collapsing keeps the optimal values:
+		collapsed_end_components collapsed;
+		if constexpr (feature_toggle::COLLAPSE_ZERO_REWARD_END_COMPONENTS) {
+			collapsed = collapse_zero_reward_end_components(m);
+			for (const auto& representative_paired_members : collapsed.components) {
+				std::string members;
+				for (const auto& member : representative_paired_members.second) {
+					members += std::string(members.empty() ? "" : ", ") + member;
+				}
+				standard_logger()->info(std::string("Collapsed zero reward end component into   ") + representative_paired_members.first + "   :   " + members);
+			}
+		}
+
 		std::vector<std::string> ordered_variables;
 		std::copy(m.states.cbegin(), m.states.cend(), std::back_inserter(ordered_variables));
 
-		optimize_scheduler(m, ordered_variables);
+		optimize_scheduler(m, ordered_variables, solver, policy_iteration, interval_iteration, collapsed);
 		goto before_return;
 	}
 
@@ -1045,7 +1292,7 @@ int run_starting_from_merged_json(const nlohmann::json& merged_json) { // do-che
 
 		standard_logger()->trace(mdp_to_json(n).dump(3));
 
-		optimize_scheduler(n, ordered_variables);
+		optimize_scheduler(n, ordered_variables, solver, policy_iteration, interval_iteration);
 		goto before_return;
 	}
 
@@ -1080,7 +1327,7 @@ int run_starting_from_merged_json(const nlohmann::json& merged_json) { // do-che
 		standard_logger()->info("Unfolding MDP...");
 		n = unfold(m, c, delta_max, ordered_variables);
 
-		optimize_scheduler(n, ordered_variables);
+		optimize_scheduler(n, ordered_variables, solver, policy_iteration, interval_iteration);
 		goto before_return;
 	}
 
@@ -1155,7 +1402,7 @@ int run_starting_from_merged_json(const nlohmann::json& merged_json) { // do-che
 			stupid_unfolded_mdp = stupid_unfold(m, cut_level, ordered_variables, augmented_state_to_pair); // unfolding without any reward changes
 			standard_logger()->trace("Done: stupid_unfold");
 
-			auto tup = check_all_exponential_schedulers_for_hVar(m, stupid_unfolded_mdp, lambda, cut_level, ordered_variables); // tries all schedulers and returns the ones leading to maximum expected mu-hVar.
+			auto tup = check_all_exponential_schedulers_for_hVar(m, stupid_unfolded_mdp, lambda, cut_level, ordered_variables, solver); // tries all schedulers and returns the ones leading to maximum expected mu-hVar.
 			standard_logger()->trace("Done: exponential scheduler check");
 
 			cut_level_to_optimal_solutions.push_back(std::make_tuple(cut_level, std::move(tup), std::vector<std::pair<rational_type, std::map<std::string, std::size_t>>>()));
@@ -1320,7 +1567,7 @@ int run_starting_from_merged_json(const nlohmann::json& merged_json) { // do-che
 
 		// best seen penalized expectation, seen classical expectations, seen matching schedulers
 		std::tuple<rational_type, std::vector <rational_type>, std::vector<scheduler_container>> tup =
-			check_all_exponential_schedulers_for_hVar(m, stupid_unfolded_mdp, lambda, cut_level, ordered_variables); // tries all schedulers and returns the ones leading to maximum expected mu-hVar.
+			check_all_exponential_schedulers_for_hVar(m, stupid_unfolded_mdp, lambda, cut_level, ordered_variables, solver); // tries all schedulers and returns the ones leading to maximum expected mu-hVar.
 		standard_logger()->trace("Done: exponential scheduler check");
 
 		//optimal_solutions = std::make_tuple(cut_level, std::move(tup), std::vector<std::pair<rational_type, std::map<std::string, std::size_t>>>());
@@ -1565,7 +1812,7 @@ int run_starting_from_merged_json(const nlohmann::json& merged_json) { // do-che
 
 				//standard_logger()->trace(mdp_to_json(n).dump(3));
 
-				optimize_scheduler<false>(n, ordered_variables);
+				optimize_scheduler<false>(n, ordered_variables, solver, policy_iteration, interval_iteration);
 				std::chrono::steady_clock::time_point time_stamp_after = std::chrono::steady_clock::now();
 
 				if (next_mdp) { // if not finished
@@ -8,10 +8,15 @@
 
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <optional>
 #include <set>
 #include <map>
 #include <list>
 #include <string>
+#include <vector>
 
 
 template <class IteratorA, class IteratorB>
@@ -179,6 +184,19 @@ public:
 	}
 
 
+	/*
+		Chooses the scheduler with number index in the order of operator++: a mixed radix number, the first state of sched is the lowest digit.
+		@return false if index is not below number_of_schedulers(), then sched is unspecified
+	*/
+	bool assign_index(big_int_type index) {
+		for (auto& [state, action_index] : sched) {
+			const big_int_type radix{ available_actions_per_state.at(state).size() };
+			action_index = big_int_type(index % radix).convert_to<std::size_t>();
+			index /= radix;
+		}
+		return index == 0;
+	}
+
 	rational_type number_of_schedulers() noexcept {
 		rational_type result{ 1 };
 		for (auto pair : available_actions_per_state) {
@@ -211,6 +229,27 @@ public:
 		}
 	}
 
+	/*
+		Chooses the given action per state, entries with unknown states or actions not enabled in the state are ignored.
+		@return number of states where the given action was chosen
+	*/
+	std::size_t choose_actions(const std::map<std::string, std::string>& actions) {
+		std::size_t count_chosen{ 0 };
+		for (const auto& [state, action] : actions) {
+			const auto found = available_actions_per_state.find(state);
+			if (found == available_actions_per_state.cend()) {
+				continue;
+			}
+			const auto action_iter = std::find(found->second.cbegin(), found->second.cend(), action);
+			if (action_iter == found->second.cend()) {
+				continue;
+			}
+			sched[state] = action_iter - found->second.cbegin();
+			++count_chosen;
+		}
+		return count_chosen;
+	}
+
 };
 
 inline mdp stupid_unfold(const mdp& m, const rational_type& cut_level, std::vector<std::string>& ordered_variables, std::map<std::string, std::pair<std::string, rational_type>>& augmentated_state_to_pair) { // do-check!
@@ -298,8 +337,26 @@ inline mdp stupid_unfold(const mdp& m, const rational_type& cut_level, std::vect
 	return n;
 }
 
+/*
+	The reward of an unfolded (state, action) in terms of the modification: modify(next_accumulated) - modify(accumulated),
+	for the state in front of the initial state only modify(next_accumulated).
+	Allows to evaluate the rewards for another modification without unfolding again, the unfolded mdp does not depend on the modification.
+*/
+struct modified_reward_arguments {
+	std::optional<rational_type> accumulated;
+	rational_type next_accumulated;
+
+	template<class _Modification>
+	rational_type evaluate(const _Modification& modify) const {
+		return accumulated ? modify(next_accumulated) - modify(*accumulated) : modify(next_accumulated);
+	}
+};
+
+/*
+	@param reward_arguments if not nullptr, gets the arguments of the modification for every reward of the unfolded mdp: state -> action -> arguments
+*/
 template<class _Modification>
-inline mdp modified_stupid_unfold(const mdp& m, const rational_type& cut_level, std::vector<std::string>& ordered_variables, const _Modification& modify, scheduler_container& cont2) { // do-check!
+inline mdp modified_stupid_unfold(const mdp& m, const rational_type& cut_level, std::vector<std::string>& ordered_variables, const _Modification& modify, scheduler_container& cont2, std::map<std::string, std::map<std::string, modified_reward_arguments>>* reward_arguments = nullptr) { // do-check!
 
 	std::list<further_expand_record> further_expand;
 	/*
@@ -333,6 +390,9 @@ inline mdp modified_stupid_unfold(const mdp& m, const rational_type& cut_level,
 
 	n.probabilities[pre_init_name][the_action][initial_state_name] = rational_type(1);
 	n.rewards[pre_init_name][the_action] = modify(rational_type(0));
+	if (reward_arguments) {
+		(*reward_arguments)[pre_init_name][the_action] = modified_reward_arguments{ std::nullopt, rational_type(0) };
+	}
 
 
 	n.states.insert(initial_state_name);
@@ -368,6 +428,9 @@ inline mdp modified_stupid_unfold(const mdp& m, const rational_type& cut_level,
 			rational_type m_next_rew = expand.accumulated_reward + step_reward;
 
 			n.rewards[expand.augmented_state_name][action_name] = modify(m_next_rew) - modify(expand.accumulated_reward); // FOR stupid_unfold use the value as it is
+			if (reward_arguments) {
+				(*reward_arguments)[expand.augmented_state_name][action_name] = modified_reward_arguments{ expand.accumulated_reward, m_next_rew };
+			}
 			// we need to check if we passed threshold + delta_max....
 
 			for (const auto& choose_next_state : distr) {
@@ -407,47 +470,132 @@ max delta otherwise
 -m.negative_loop_delta_threshold() if there is a negative loop
 */
 
-template <bool WRITE_LOG = true>
-inline std::map<std::string, rational_type> calc_delta_max_state_wise(const mdp& m, bool ignore_target_states, bool error_on_negative_loop) { // do-check!
-	// should only check for negative circles
+/*
+	Edges of the graph used by calc_delta_max_state_wise, states are numbered in the order of m.states.
+	There is an edge s -> s' with the reward of a for every action a of s and every successor s' of (s, a), also for probability 0.
+*/
+class delta_max_graph {
+public:
+	struct edge {
+		std::size_t target;
+		rational_type reward;
+		const std::string* action; // points into mdp::probabilities of the mdp the graph was built from
+	};
 
-	std::map<std::string, rational_type> result;
+	std::vector<std::vector<edge>> successors;
+	std::vector<std::vector<std::size_t>> predecessors; // without duplicates
 
-	for (const auto& state : m.states) {
-		result[state] = rational_type(0);
+	/*
+		@return per state in the order of m.states whether it gets no outgoing edges
+	*/
+	static std::vector<bool> skipped_states(const mdp& m, bool ignore_target_states) {
+		std::vector<bool> skip(m.states.size(), false);
+		if (ignore_target_states) {
+			std::size_t id{ 0 };
+			for (const auto& state : m.states) {
+				skip[id++] = set_contains(m.targets, state);
+			}
+		}
+		return skip;
 	}
 
-	bool continue_loop = true;
-	while (continue_loop) {
-		continue_loop = false;
+	/*
+		@param skip states without outgoing edges
+	*/
+	delta_max_graph(const mdp& m, const std::vector<bool>& skip) : successors(m.states.size()), predecessors(m.states.size()) {
+		std::map<std::string, std::size_t> index;
 		for (const auto& state : m.states) {
-			if (ignore_target_states && set_contains(m.targets, state)) {
-				continue;
-			}
-			try {
+			index.emplace(state, index.size());
+		}
+		std::size_t id{ 0 };
+		for (const auto& state : m.states) {
+			if (!skip[id]) {
 				const auto& actions{ m.probabilities.at(state) }; // building MDP ensures an entry for every state, even if left in json
 				for (const auto& action_tree : actions) {
+					const auto& reward{ m.rewards.at(state).at(action_tree.first) }; // building MDP ensures an entry for every state,action, even if left in json
 					for (const auto& next_state_pair : action_tree.second) {
-						rational_type update = std::max(
-							m.negative_loop_delta_threshold() - rational_type(1),
-							std::min(result[state], result[next_state_pair.first] + m.rewards.at(state).at(action_tree.first)) // building MDP ensures an entry for every state,action, even if left in json
-						);
-						if (result[state] != update)
-							continue_loop = true;
-						result[state] = update;
-						if (update < m.negative_loop_delta_threshold()) {
-							if (error_on_negative_loop) {
-								throw found_negative_loop("Found negative loop while determining delta max.");
-							}
+						const std::size_t target{ index.at(next_state_pair.first) };
+						successors[id].push_back(edge{ target, reward, &action_tree.first });
+						if (predecessors[target].empty() || predecessors[target].back() != id) {
+							predecessors[target].push_back(id);
 						}
-						if constexpr (WRITE_LOG) standard_logger()->trace(std::string("UPDATE delta_m for  >" + state + "<  :" + update.numerator().str() + "/" + update.denominator().str()));
 					}
 				}
 			}
-			catch (const std::out_of_range&) {
-				throw calc_delta_max_error("Fatal internal error: The MDP that was build internally from json does not meet a constraint that is required for calculating delta max. Probably some out-of-range on a map occureed.");
+			++id;
+		}
+	}
+};
+
+template <bool WRITE_LOG = true>
+inline std::map<std::string, rational_type> calc_delta_max_state_wise(const mdp& m, bool ignore_target_states, bool error_on_negative_loop, const std::atomic<bool>* cancelled = nullptr) { // do-check!
+	// should only check for negative circles
+	/*
+		Label correcting shortest paths (worklist / SPFA): delta(s) is the minimal accumulated reward of a finite path starting in s (the empty path gives 0),
+		bounded below by negative_loop_delta_threshold() - 1. Only states with a successor whose value decreased are examined again.
+		A value below the threshold, or a state decreased more often than there are states, means a negative loop.
+		If cancelled is set while running, analysis_cancelled is thrown.
+	*/
+
+	const std::size_t count_states{ m.states.size() };
+	const std::vector<bool> skip{ delta_max_graph::skipped_states(m, ignore_target_states) };
+
+	std::unique_ptr<delta_max_graph> graph;
+	try {
+		graph = std::make_unique<delta_max_graph>(m, skip);
+	}
+	catch (const std::out_of_range&) {
+		throw calc_delta_max_error("Fatal internal error: The MDP that was build internally from json does not meet a constraint that is required for calculating delta max. Probably some out-of-range on a map occureed.");
+	}
+
+	const rational_type threshold{ m.negative_loop_delta_threshold() };
+	const rational_type lowest_value{ threshold - rational_type(1) };
+	std::vector<std::string> names(m.states.cbegin(), m.states.cend());
+	std::vector<rational_type> delta(count_states, rational_type(0));
+	std::vector<std::size_t> count_decreased(count_states, 0);
+	std::vector<bool> in_queue(count_states, false);
+	std::deque<std::size_t> queue;
+	for (std::size_t id{ 0 }; id < count_states; ++id) {
+		if (!skip[id]) {
+			queue.push_back(id);
+			in_queue[id] = true;
+		}
+	}
+
+	while (!queue.empty()) {
+		analysis_cancelled::check(cancelled);
+		const std::size_t id{ queue.front() };
+		queue.pop_front();
+		in_queue[id] = false;
+
+		rational_type update{ delta[id] };
+		for (const auto& e : graph->successors[id]) {
+			const rational_type candidate{ delta[e.target] + e.reward };
+			if (candidate < update) {
+				update = candidate;
 			}
 		}
+		update = std::max(lowest_value, update);
+		if (!(update < delta[id])) {
+			continue;
+		}
+		delta[id] = update;
+		++count_decreased[id];
+		if constexpr (WRITE_LOG) standard_logger()->trace(std::string("UPDATE delta_m for  >" + names[id] + "<  :" + update.numerator().str() + "/" + update.denominator().str()));
+		if (error_on_negative_loop && (update < threshold || count_decreased[id] > count_states)) {
+			throw found_negative_loop("Found negative loop while determining delta max.");
+		}
+		for (const auto& predecessor : graph->predecessors[id]) {
+			if (!in_queue[predecessor]) {
+				queue.push_back(predecessor);
+				in_queue[predecessor] = true;
+			}
+		}
+	}
+
+	std::map<std::string, rational_type> result;
+	for (std::size_t id{ 0 }; id < count_states; ++id) {
+		result.emplace_hint(result.cend(), names[id], delta[id]);
 	}
 
 	for (auto& pair : result) // convert into positive values!
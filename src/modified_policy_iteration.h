@@ -0,0 +1,267 @@
+#pragma once
+
+#include "policy_model.h"
+#include "sparse_elimination.h"
+
+#include <cmath>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+	Modified policy iteration: while the scheduler is still far from optimal it is improved using approximate values only,
+	either some value update sweeps in floating point per round or a floating point solution of the scheduler's system.
+	The approximation never decides about optimality, afterwards optimize_scheduler continues with exact policy iteration
+	starting from the scheduler found here. Its first round certifies the scheduler: one exact evaluation and an exact improvement check.
+	Only if the check finds an improvement, further exact rounds are needed.
+*/
+
+enum class policy_evaluation {
+	exact, // no approximate rounds at all
+	sweeps, // some Gauss-Seidel value update sweeps per round
+	floating_point // solving the system of the scheduler in floating point
+};
+
+inline std::string to_string(policy_evaluation evaluation) {
+	switch (evaluation) {
+	case policy_evaluation::exact:
+		return "exact";
+	case policy_evaluation::sweeps:
+		return "sweeps";
+	case policy_evaluation::floating_point:
+		return "floating-point";
+	}
+	return "unknown";
+}
+
+struct policy_iteration_configuration {
+	policy_evaluation evaluation{ policy_evaluation::exact };
+	std::size_t sweeps{ 20 }; // per round, only for policy_evaluation::sweeps
+	std::size_t max_approximate_rounds{ 1000 };
+
+	// warm start, states without a valid entry start with their first action:
+	std::map<std::string, std::string> initial_actions; // state -> action
+	bool reuse_previous_scheduler{ false }; // start from the result of the previous optimize_scheduler in this process, initial_actions take precedence
+
+	bool eliminate_actions{ false }; // remove actions that cannot be optimal according to cheap value bounds before starting
+};
+
+/*
+	The optimal scheduler of the last optimize_scheduler call which had reuse_previous_scheduler set, as state -> action.
+*/
+class previous_scheduler {
+	inline static std::mutex access;
+	inline static std::map<std::string, std::string> actions;
+
+public:
+	static std::map<std::string, std::string> get() {
+		std::lock_guard<std::mutex> lock(access);
+		return actions;
+	}
+
+	static void set(std::map<std::string, std::string> new_actions) {
+		std::lock_guard<std::mutex> lock(access);
+		actions = std::move(new_actions);
+	}
+};
+
+inline std::string to_string(const policy_iteration_configuration& configuration) {
+	std::string result{ to_string(configuration.evaluation) };
+	if (configuration.evaluation == policy_evaluation::sweeps) {
+		result += "   with sweeps per round:   " + std::to_string(configuration.sweeps);
+	}
+	return result;
+}
+
+/*
+	The action tables of a dense_policy_model converted to floating point.
+*/
+template <class Float = long double>
+class approximate_policy_model {
+	const dense_policy_model* model;
+	std::vector<Float> rewards;
+	std::vector<Float> probabilities;
+
+public:
+
+	explicit approximate_policy_model(const dense_policy_model& model) : model(&model) {
+		rewards.reserve(model.count_all_actions());
+		for (std::size_t a{ 0 }; a < model.count_all_actions(); ++a) {
+			rewards.push_back(linear_systems::rational_to_floating_point<Float>(model.action_reward(a)));
+		}
+		const std::size_t count_transitions{ model.count_all_actions() == 0 ? 0 : model.transitions_end(model.count_all_actions() - 1) };
+		probabilities.reserve(count_transitions);
+		for (std::size_t t{ 0 }; t < count_transitions; ++t) {
+			probabilities.push_back(linear_systems::rational_to_floating_point<Float>(model.probability(t)));
+		}
+	}
+
+	/*
+		@return expectation of v over the successors of action
+	*/
+	Float expectation(linear_systems::var_id state, std::size_t action, const std::vector<Float>& v) const {
+		const std::size_t a{ model->global_action(state, action) };
+		Float accummulated{ 0 };
+		for (std::size_t t{ model->transitions_begin(a) }; t < model->transitions_end(a); ++t) {
+			accummulated += probabilities[t] * v[model->successor(t)];
+		}
+		return accummulated;
+	}
+
+	Float action_value(linear_systems::var_id state, std::size_t action, const std::vector<Float>& v) const {
+		return rewards[model->global_action(state, action)] + expectation(state, action, v);
+	}
+
+	Float min_reward() const {
+		return rewards.empty() ? Float(0) : *std::min_element(rewards.cbegin(), rewards.cend());
+	}
+
+	Float max_reward() const {
+		return rewards.empty() ? Float(0) : *std::max_element(rewards.cbegin(), rewards.cend());
+	}
+
+	/*
+		One Gauss-Seidel sweep v(s) := r(s, d(s)) + sum_s' P(s, d(s), s') v(s'), resolved states keep their value.
+		@return maximal change of a value
+	*/
+	Float sweep(const dense_policy_model::dense_scheduler& decisions, std::vector<Float>& v) const {
+		Float max_change{ 0 };
+		for (linear_systems::var_id state{ 0 }; state < model->count_states(); ++state) {
+			if (model->is_resolved(state)) {
+				continue;
+			}
+			const Float updated{ action_value(state, decisions[state], v) };
+			max_change = std::max(max_change, std::fabs(updated - v[state]));
+			v[state] = updated;
+		}
+		return max_change;
+	}
+
+	/*
+		(I - P_sched) x = rew in floating point, built from the converted tables, so no rational number is touched.
+	*/
+	void create_matrix(const dense_policy_model::dense_scheduler& decisions, linear_systems::generic_matrix<Float>& mat, std::vector<Float>& rew) const {
+		mat.assign(model->count_states(), linear_systems::generic_matrix_line<Float>());
+		rew.assign(model->count_states(), Float(0));
+		for (linear_systems::var_id state{ 0 }; state < model->count_states(); ++state) {
+			if (model->is_resolved(state)) { // a target state or a state of value 0
+				mat[state].emplace_back(state, Float(1));
+				continue;
+			}
+			const std::size_t a{ model->global_action(state, decisions[state]) };
+			rew[state] = rewards[a];
+			bool extra_diagonal_entry{ true };
+			for (std::size_t t{ model->transitions_begin(a) }; t < model->transitions_end(a); ++t) {
+				Float value{ -probabilities[t] };
+				if (model->successor(t) == state) {
+					value += Float(1);
+					extra_diagonal_entry = false;
+				}
+				mat[state].emplace_back(model->successor(t), value);
+			}
+			if (extra_diagonal_entry) {
+				mat[state].emplace_back(state, Float(1));
+			}
+		}
+	}
+
+	/*
+		Solves the system of decisions in floating point, the elimination order is taken from the current lines of builder.
+		@return false if the elimination failed
+	*/
+	bool evaluate(const dense_policy_model::dense_scheduler& decisions, const policy_matrix_builder& builder, linear_systems::variable_ordering ordering, std::vector<Float>& v) const {
+		linear_systems::id_vector elimination_order{ builder.unresolved_variables(ordering) };
+		std::copy(builder.resolved_variables().cbegin(), builder.resolved_variables().cend(), std::back_inserter(elimination_order));
+		linear_systems::generic_matrix<Float> mat;
+		create_matrix(decisions, mat, v);
+		return linear_systems::solve_linear_system_sparse_elimination(std::move(mat), v, elimination_order);
+	}
+
+};
+
+/*
+	Improves decisions (and the lines of builder accordingly) by approximate policy iteration.
+	An action only replaces the current one if it is better by more than a relative tolerance, so rounding cannot cause cycling.
+	If the values diverge (e.g. under a scheduler not reaching the target) the decisions are reset to the ones given.
+	@return number of approximate rounds done
+*/
+template <class Float = long double>
+std::size_t approximate_policy_iteration(
+	const dense_policy_model& model,
+	policy_matrix_builder& builder,
+	dense_policy_model::dense_scheduler& decisions,
+	const policy_iteration_configuration& configuration,
+	linear_systems::variable_ordering ordering
+) {
+	if (configuration.evaluation == policy_evaluation::exact) {
+		return 0;
+	}
+	const Float tolerance{ std::sqrt(std::numeric_limits<Float>::epsilon()) };
+	const auto is_finite = [](const std::vector<Float>& v) {
+		return std::all_of(v.cbegin(), v.cend(), [](const Float& value) { return std::isfinite(value); });
+	};
+	const auto max_absolute_value = [](const std::vector<Float>& v) {
+		Float result{ 0 };
+		for (const auto& value : v) {
+			result = std::max(result, std::fabs(value));
+		}
+		return result;
+	};
+
+	const approximate_policy_model<Float> approximate(model);
+	const dense_policy_model::dense_scheduler initial_decisions{ decisions };
+	std::vector<Float> v(model.count_states(), Float(0));
+
+	std::size_t round{ 0 };
+	while (round < configuration.max_approximate_rounds) {
+		++round;
+
+		// evaluate approximately:
+		Float last_change{ 0 };
+		if (configuration.evaluation == policy_evaluation::sweeps) {
+			for (std::size_t i{ 0 }; i < configuration.sweeps; ++i) {
+				last_change = approximate.sweep(decisions, v);
+			}
+		}
+		else if (!approximate.evaluate(decisions, builder, ordering, v)) {
+			break;
+		}
+		if (!is_finite(v)) {
+			for (linear_systems::var_id state{ 0 }; state < model.count_states(); ++state) {
+				if (model.count_actions(state) != 0 && decisions[state] != initial_decisions[state]) {
+					builder.change_decision(state, initial_decisions[state]);
+				}
+			}
+			decisions = initial_decisions;
+			break;
+		}
+
+		// greedy improvement:
+		bool changed{ false };
+		for (linear_systems::var_id state{ 0 }; state < model.count_states(); ++state) {
+			if (model.count_actions(state) == 0) {
+				continue;
+			}
+			std::size_t select_action{ decisions[state] };
+			Float best_seen_value{ approximate.action_value(state, select_action, v) };
+			for (std::size_t action{ 0 }; action < model.count_actions(state); ++action) {
+				const Float value{ approximate.action_value(state, action, v) };
+				if (value > best_seen_value + tolerance * std::max(Float(1), std::fabs(best_seen_value))) {
+					select_action = action;
+					best_seen_value = value;
+				}
+			}
+			if (select_action != decisions[state]) {
+				decisions[state] = select_action;
+				builder.change_decision(state, select_action);
+				changed = true;
+			}
+		}
+		if (!changed && last_change <= tolerance * std::max(Float(1), max_absolute_value(v))) {
+			break; // stable scheduler and (for sweeps) converged values
+		}
+	}
+	return round;
+}
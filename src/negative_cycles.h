@@ -0,0 +1,222 @@
+#pragma once
+
+#include "mdp_ops.h"
+#include "variable_ordering.h"
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <vector>
+
+/*
+	Direct search for negative reward loops:
+	the graph of calc_delta_max_state_wise is split into strongly connected components,
+	for each component the cycle with minimal mean reward per step is computed by Howard's policy iteration.
+	There is a negative loop if and only if some minimal mean is negative, and then that cycle is a witness.
+*/
+
+struct reward_cycle {
+	std::vector<std::string> states; // states[i] --actions[i]--> states[i + 1], the last state goes back to the first one
+	std::vector<std::string> actions;
+	rational_type accumulated_reward;
+};
+
+inline std::string to_string(const reward_cycle& cycle) {
+	std::string result;
+	for (std::size_t i{ 0 }; i < cycle.states.size(); ++i) {
+		result += cycle.states[i] + "  --" + cycle.actions[i] + "-->  ";
+	}
+	if (!cycle.states.empty()) {
+		result += cycle.states.front();
+	}
+	return result + "   accumulated reward:   " + cycle.accumulated_reward.numerator().str() + "/" + cycle.accumulated_reward.denominator().str();
+}
+
+/*
+	Howard's policy iteration for the minimum mean cycle inside one strongly connected component:
+	every state chooses one edge inside the component, the chosen edges lead into cycles.
+	eta(s) is the mean reward of the cycle reached from s, x(s) a potential with x(s) = w(s) - eta(s) + x(successor).
+	A state switches to an edge leading to a smaller eta, or if there is none, to an edge with equal eta and smaller potential.
+	@param component needs at least one edge inside
+	@return per state of the component the index of its chosen edge in graph.successors, the start of a minimum mean cycle and its mean
+*/
+inline std::tuple<std::vector<std::size_t>, std::size_t, rational_type> minimum_mean_cycle(const delta_max_graph& graph, const linear_systems::id_vector& component, const std::vector<bool>& in_component) {
+	constexpr std::size_t NONE{ std::numeric_limits<std::size_t>::max() };
+	const std::size_t count_nodes{ graph.successors.size() };
+
+	std::vector<std::size_t> policy(count_nodes, NONE);
+	for (const auto& v : component) { // start with the cheapest edge inside the component
+		for (std::size_t i{ 0 }; i < graph.successors[v].size(); ++i) {
+			const auto& e{ graph.successors[v][i] };
+			if (in_component[e.target] && (policy[v] == NONE || e.reward < graph.successors[v][policy[v]].reward)) {
+				policy[v] = i;
+			}
+		}
+	}
+	const auto next = [&](std::size_t v) { return graph.successors[v][policy[v]].target; };
+	const auto reward = [&](std::size_t v) -> const rational_type& { return graph.successors[v][policy[v]].reward; };
+
+	std::vector<rational_type> eta(count_nodes);
+	std::vector<rational_type> potential(count_nodes);
+	std::vector<std::size_t> walk_id(count_nodes, NONE); // NONE: not yet evaluated in this round
+	std::vector<bool> evaluated(count_nodes, false);
+
+	while (true) {
+		// evaluate the policy:
+		for (const auto& v : component) {
+			walk_id[v] = NONE;
+			evaluated[v] = false;
+		}
+		for (const auto& start : component) {
+			if (evaluated[start]) {
+				continue;
+			}
+			linear_systems::id_vector walk;
+			std::size_t v{ start };
+			while (!evaluated[v] && walk_id[v] == NONE) {
+				walk_id[v] = start;
+				walk.push_back(v);
+				v = next(v);
+			}
+			std::size_t resolved_until{ walk.size() }; // walk[i] for i >= resolved_until have eta and potential
+			if (!evaluated[v]) { // found a new cycle starting at v
+				const std::size_t cycle_begin = std::find(walk.cbegin(), walk.cend(), v) - walk.cbegin();
+				rational_type sum{ 0 };
+				for (std::size_t i{ cycle_begin }; i < walk.size(); ++i) {
+					sum += reward(walk[i]);
+				}
+				const rational_type mean{ sum / rational_type(walk.size() - cycle_begin) };
+				eta[v] = mean;
+				potential[v] = 0;
+				evaluated[v] = true;
+				for (std::size_t i{ walk.size() - 1 }; i > cycle_begin; --i) {
+					eta[walk[i]] = mean;
+					potential[walk[i]] = reward(walk[i]) - mean + potential[next(walk[i])];
+					evaluated[walk[i]] = true;
+				}
+				resolved_until = cycle_begin;
+			}
+			for (std::size_t i{ resolved_until }; i-- > 0;) {
+				const std::size_t w{ walk[i] };
+				eta[w] = eta[next(w)];
+				potential[w] = reward(w) - eta[w] + potential[next(w)];
+				evaluated[w] = true;
+			}
+		}
+
+		// improve the policy, first by eta:
+		bool changed{ false };
+		for (const auto& v : component) {
+			for (std::size_t i{ 0 }; i < graph.successors[v].size(); ++i) {
+				const auto& e{ graph.successors[v][i] };
+				if (in_component[e.target] && eta[e.target] < eta[next(v)]) {
+					policy[v] = i;
+					changed = true;
+				}
+			}
+		}
+		if (changed) {
+			continue;
+		}
+		// ... then by potential:
+		for (const auto& v : component) {
+			rational_type best{ potential[v] };
+			for (std::size_t i{ 0 }; i < graph.successors[v].size(); ++i) {
+				const auto& e{ graph.successors[v][i] };
+				if (in_component[e.target] && eta[e.target] == eta[v]) {
+					const rational_type candidate{ e.reward - eta[v] + potential[e.target] };
+					if (candidate < best) {
+						best = candidate;
+						policy[v] = i;
+						changed = true;
+					}
+				}
+			}
+		}
+		if (!changed) {
+			break;
+		}
+	}
+
+	std::size_t best_start{ component.front() };
+	for (const auto& v : component) {
+		if (eta[v] < eta[best_start]) {
+			best_start = v;
+		}
+	}
+	// go to the cycle:
+	std::vector<bool> seen(count_nodes, false);
+	while (!seen[best_start]) {
+		seen[best_start] = true;
+		best_start = next(best_start);
+	}
+	return std::make_tuple(policy, best_start, eta[best_start]);
+}
+
+/*
+	@param ignore_target_states as for calc_delta_max_state_wise, loops leaving a target state are not considered
+	@param cancelled checked per component, see analysis_cancelled
+	@return false if there is no negative loop, otherwise true and a witness in cycle
+*/
+inline bool find_negative_cycle(const mdp& m, bool ignore_target_states, reward_cycle& cycle, const std::atomic<bool>* cancelled = nullptr) {
+	const std::size_t count_states{ m.states.size() };
+	const delta_max_graph graph(m, delta_max_graph::skipped_states(m, ignore_target_states));
+	const std::vector<std::string> names(m.states.cbegin(), m.states.cend());
+
+	std::vector<linear_systems::id_vector> successors(count_states);
+	linear_systems::id_vector all_states;
+	for (std::size_t v{ 0 }; v < count_states; ++v) {
+		all_states.push_back(v);
+		for (const auto& e : graph.successors[v]) {
+			successors[v].push_back(e.target);
+		}
+	}
+
+	std::vector<bool> in_component(count_states, false);
+	for (const auto& component : linear_systems::strongly_connected_components(successors, all_states)) {
+		const bool has_cycle{ component.size() > 1 ||
+			std::find(successors[component.front()].cbegin(), successors[component.front()].cend(), component.front()) != successors[component.front()].cend() };
+		if (!has_cycle) {
+			continue;
+		}
+		analysis_cancelled::check(cancelled);
+		for (const auto& v : component) {
+			in_component[v] = true;
+		}
+		const auto [policy, start, mean] = minimum_mean_cycle(graph, component, in_component);
+		for (const auto& v : component) {
+			in_component[v] = false;
+		}
+		if (!(mean < rational_type(0))) {
+			continue;
+		}
+		cycle = reward_cycle{ {}, {}, rational_type(0) };
+		std::size_t v{ start };
+		do {
+			const auto& e{ graph.successors[v][policy[v]] };
+			cycle.states.push_back(names[v]);
+			cycle.actions.push_back(*e.action);
+			cycle.accumulated_reward += e.reward;
+			v = e.target;
+		} while (v != start);
+		return true;
+	}
+	return false;
+}
+
+/*
+	@throws found_negative_loop naming a negative loop
+*/
+inline void check_no_negative_cycle(const mdp& m, bool ignore_target_states, const std::atomic<bool>* cancelled = nullptr) {
+	reward_cycle cycle;
+	try {
+		if (!find_negative_cycle(m, ignore_target_states, cycle, cancelled)) {
+			return;
+		}
+	}
+	catch (const std::out_of_range&) {
+		throw calc_delta_max_error("Fatal internal error: The MDP that was build internally from json does not meet a constraint that is required for searching negative loops. Probably some out-of-range on a map occureed.");
+	}
+	throw found_negative_loop(std::string("Found negative loop:   ") + to_string(cycle));
+}
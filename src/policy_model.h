@@ -0,0 +1,389 @@
+#pragma once
+
+#include "mdp_ops.h"
+#include "linear_system.h"
+#include "variable_ordering.h"
+#include "qualitative_reachability.h"
+
+#include <algorithm>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/*
+	Dense representation of an mdp for policy iteration.
+	States are identified by their index in ordered_variables, the actions of a state by their index in scheduler_container::available_actions_per_state.
+	All actions of all states are stored in one table, state s owns the actions [first_action[s], first_action[s + 1]).
+	All transitions are stored in one table as well, action a owns the transitions [first_transition[a], first_transition[a + 1]),
+	in the order of the successor names like in mdp::probabilities.
+	So no string is looked up while building systems or improving a scheduler.
+	Besides the targets, the states with accumulated reward 0 under every scheduler (see zero_value_states) are resolved with value 0,
+	they get the line x = 0 whatever the scheduler chooses, so they drop out of every system.
+*/
+
+using state_index = std::unordered_map<std::string, linear_systems::var_id>;
+
+inline state_index make_state_index(const std::vector<std::string>& ordered_variables) {
+	state_index index;
+	index.reserve(ordered_variables.size());
+	for (linear_systems::var_id i{ 0 }; i < ordered_variables.size(); ++i) {
+		index.emplace(ordered_variables[i], i);
+	}
+	return index;
+}
+
+inline linear_systems::var_id get_index(const state_index& index, const std::string& s) {
+	const auto found = index.find(s);
+	if (found == index.cend()) {
+		throw std::logic_error("String not contained in string vector.");
+	}
+	return found->second;
+}
+
+/*
+	Splits the states [0, count_states) into contiguous chunks and calls body(begin, end) for all chunks concurrently.
+	@return the results of body in chunk order, so they can be reduced deterministically, independent of the thread timing.
+*/
+template <class Body>
+inline auto for_each_state_chunk(std::size_t count_states, Body body) -> std::vector<decltype(body(std::size_t(), std::size_t()))> {
+	constexpr std::size_t MIN_STATES_PER_CHUNK{ 512 }; // below, starting a thread costs more than the work
+	const std::size_t count_chunks{ std::clamp<std::size_t>(count_states / MIN_STATES_PER_CHUNK, 1, std::max<std::size_t>(1, std::thread::hardware_concurrency())) };
+
+	std::vector<decltype(body(std::size_t(), std::size_t()))> results;
+	if (count_chunks == 1) {
+		results.push_back(body(0, count_states));
+		return results;
+	}
+	std::vector<std::future<decltype(body(std::size_t(), std::size_t()))>> the_futures;
+	for (std::size_t chunk{ 0 }; chunk < count_chunks; ++chunk) {
+		the_futures.emplace_back(std::async(std::launch::async, body, count_states * chunk / count_chunks, count_states * (chunk + 1) / count_chunks));
+	}
+	for (auto& future : the_futures) {
+		results.push_back(future.get());
+	}
+	return results;
+}
+
+class dense_policy_model {
+public:
+	using dense_scheduler = std::vector<std::size_t>; // per state the index of the chosen action, meaningless for states without actions
+
+private:
+	std::vector<std::size_t> first_action;
+	std::vector<rational_type> action_rewards;
+	std::vector<std::size_t> first_transition;
+	linear_systems::id_vector successors;
+	std::vector<rational_type> probabilities;
+	linear_systems::id_vector targets; // sorted
+	linear_systems::id_vector resolved; // sorted, targets and zero value states
+	std::vector<bool> is_resolved_flags;
+
+public:
+
+	dense_policy_model(const mdp& m, const std::vector<std::string>& ordered_variables, const scheduler_container& cont) {
+		const state_index index{ make_state_index(ordered_variables) };
+
+		first_action.reserve(ordered_variables.size() + 1);
+		first_transition.push_back(0);
+		for (const auto& state : ordered_variables) {
+			first_action.push_back(action_rewards.size());
+			for (const auto& action : cont.available_actions_per_state.at(state)) {
+				action_rewards.push_back(m.rewards.at(state).at(action));
+				for (const auto& state_paired_rational : m.probabilities.at(state).at(action)) {
+					successors.push_back(get_index(index, state_paired_rational.first));
+					probabilities.push_back(state_paired_rational.second);
+				}
+				first_transition.push_back(successors.size());
+			}
+		}
+		first_action.push_back(action_rewards.size());
+
+		for (const auto& target : m.targets) {
+			targets.push_back(get_index(index, target));
+		}
+		std::sort(targets.begin(), targets.end());
+
+		is_resolved_flags.assign(count_states(), false);
+		for (const auto& target : targets) {
+			is_resolved_flags[target] = true;
+		}
+		std::vector<bool> zero_reward(count_all_actions());
+		for (std::size_t a{ 0 }; a < count_all_actions(); ++a) {
+			zero_reward[a] = action_rewards[a] == rational_type(0);
+		}
+		const std::vector<bool> zero_value{ zero_value_states(make_qualitative_graph(), is_resolved_flags, zero_reward) };
+		for (linear_systems::var_id state{ 0 }; state < count_states(); ++state) {
+			if (zero_value[state]) {
+				is_resolved_flags[state] = true;
+			}
+			if (is_resolved_flags[state]) {
+				resolved.push_back(state);
+			}
+		}
+	}
+
+	std::size_t count_states() const {
+		return first_action.size() - 1;
+	}
+
+	std::size_t count_actions(linear_systems::var_id state) const {
+		return first_action[state + 1] - first_action[state];
+	}
+
+	std::size_t count_all_actions() const {
+		return action_rewards.size();
+	}
+
+	/*
+		@return index of the action of state in the action table of all states
+	*/
+	std::size_t global_action(linear_systems::var_id state, std::size_t action) const {
+		return first_action[state] + action;
+	}
+
+	const rational_type& action_reward(std::size_t global_action_id) const {
+		return action_rewards[global_action_id];
+	}
+
+	/*
+		transitions of an action are [transitions_begin(a), transitions_end(a)), see successor() and probability()
+	*/
+	std::size_t transitions_begin(std::size_t global_action_id) const {
+		return first_transition[global_action_id];
+	}
+
+	std::size_t transitions_end(std::size_t global_action_id) const {
+		return first_transition[global_action_id + 1];
+	}
+
+	linear_systems::var_id successor(std::size_t transition) const {
+		return successors[transition];
+	}
+
+	const rational_type& probability(std::size_t transition) const {
+		return probabilities[transition];
+	}
+
+	const linear_systems::id_vector& target_states() const {
+		return targets;
+	}
+
+	/*
+		@return true for targets and states of value 0 under every scheduler, their line in every system is x = 0
+	*/
+	bool is_resolved(linear_systems::var_id state) const {
+		return is_resolved_flags[state];
+	}
+
+	/*
+		@return per state is_resolved()
+	*/
+	const std::vector<bool>& resolved_flags() const {
+		return is_resolved_flags;
+	}
+
+	/*
+		@return targets and zero value states, ascending
+	*/
+	const linear_systems::id_vector& resolved_states() const {
+		return resolved;
+	}
+
+	/*
+		@return all states that are not resolved, ascending
+	*/
+	linear_systems::id_vector unresolved_states() const {
+		linear_systems::id_vector result;
+		for (linear_systems::var_id i{ 0 }; i < count_states(); ++i) {
+			if (!is_resolved_flags[i]) {
+				result.push_back(i);
+			}
+		}
+		return result;
+	}
+
+	/*
+		@return the graph of the transitions with positive probability, for the qualitative_reachability algorithms
+	*/
+	qualitative_graph make_qualitative_graph() const {
+		linear_systems::id_vector positive_successors;
+		std::vector<std::size_t> positive_first_transition{ 0 };
+		for (std::size_t a{ 0 }; a < count_all_actions(); ++a) {
+			for (std::size_t t{ first_transition[a] }; t < first_transition[a + 1]; ++t) {
+				if (probabilities[t] != rational_type(0)) {
+					positive_successors.push_back(successors[t]);
+				}
+			}
+			positive_first_transition.push_back(positive_successors.size());
+		}
+		return qualitative_graph(first_action, std::move(positive_first_transition), std::move(positive_successors));
+	}
+
+	/*
+		@return the decisions of cont.sched as dense scheduler
+	*/
+	dense_scheduler make_dense_scheduler(const std::vector<std::string>& ordered_variables, const scheduler_container& cont) const {
+		dense_scheduler decisions(count_states(), 0);
+		for (linear_systems::var_id state{ 0 }; state < count_states(); ++state) {
+			if (count_actions(state) != 0) {
+				decisions[state] = cont.sched.at(ordered_variables[state]);
+			}
+		}
+		return decisions;
+	}
+
+	/*
+		@return reward of action plus the expectation of x over its successors
+	*/
+	rational_type action_value(linear_systems::var_id state, std::size_t action, const linear_systems::rational_vector& x) const {
+		const std::size_t a{ global_action(state, action) };
+		rational_type accummulated{ action_rewards[a] };
+		for (std::size_t t{ first_transition[a] }; t < first_transition[a + 1]; ++t) {
+			accummulated += probabilities[t] * x[successors[t]];
+		}
+		return accummulated;
+	}
+
+	/*
+		line of state in the system (I - P_sched) x = rew if the scheduler chooses action at state
+	*/
+	void create_action_line(linear_systems::var_id state, std::size_t action, linear_systems::matrix_line& line, rational_type& rew) const {
+		line.clear();
+		const std::size_t a{ global_action(state, action) };
+		rew = action_rewards[a];
+		line.reserve(first_transition[a + 1] - first_transition[a] + 1);
+		bool extra_diagonal_entry{ true };
+		for (std::size_t t{ first_transition[a] }; t < first_transition[a + 1]; ++t) {
+			auto value{ probabilities[t] * rational_type(-1) };
+			if (successors[t] == state) {
+				value += rational_type(1);
+				extra_diagonal_entry = false;
+			}
+			line.push_back(std::make_pair(successors[t], value));
+		}
+		if (extra_diagonal_entry) {
+			line.push_back(std::make_pair(state, 1));
+		}
+	}
+
+	/*
+		line of state in the system (I - P_sched) x = rew
+	*/
+	void create_matrix_line(linear_systems::var_id state, const dense_scheduler& decisions, linear_systems::matrix_line& line, rational_type& rew) const {
+		if (is_resolved(state)) { // a target state or a state of value 0
+			line.clear();
+			rew = 0;
+			line.push_back(std::make_pair(state, rational_type(1)));
+			return;
+		}
+		create_action_line(state, decisions[state], line, rew);
+	}
+
+	/*
+		Builds (I - P_sched) x = rew, the targets and zero value states are the resolved variables.
+		@param ordering only changes the order of unresolved, i.e. the elimination order for the solver.
+	*/
+	void create_matrix(const dense_scheduler& decisions, linear_systems::matrix& mat, linear_systems::rational_vector& rew, linear_systems::id_vector& unresolved, linear_systems::id_vector& resolved, linear_systems::variable_ordering ordering) const {
+		mat.resize(count_states());
+		rew.resize(count_states());
+		for (linear_systems::var_id state{ 0 }; state < count_states(); ++state) {
+			create_matrix_line(state, decisions, mat[state], rew[state]);
+		}
+		resolved = resolved_states();
+		unresolved = unresolved_states();
+		linear_systems::apply_variable_ordering(ordering, mat, unresolved);
+	}
+
+};
+
+/*
+	Keeps the system (I - P_sched) x = rew of policy iteration between the iterations.
+	The lines for all (state, action) pairs are created once, changing a decision only swaps in the precomputed line.
+	The partition into resolved and unresolved variables does not depend on the scheduler and is computed once as well.
+*/
+class policy_matrix_builder {
+	const dense_policy_model* model;
+
+	linear_systems::matrix action_lines; // per entry of the action table of model
+	linear_systems::rational_vector action_rhs;
+
+	linear_systems::matrix mat;
+	linear_systems::rational_vector rew;
+	linear_systems::id_vector unresolved;
+	linear_systems::id_vector resolved;
+
+public:
+
+	policy_matrix_builder(const dense_policy_model& model, const dense_policy_model::dense_scheduler& decisions) :
+		model(&model),
+		action_lines(model.count_all_actions()),
+		action_rhs(model.count_all_actions()),
+		mat(model.count_states()),
+		rew(model.count_states()),
+		unresolved(model.unresolved_states()),
+		resolved(model.resolved_states())
+	{
+		for (linear_systems::var_id state{ 0 }; state < model.count_states(); ++state) {
+			for (std::size_t action{ 0 }; action < model.count_actions(state); ++action) {
+				const std::size_t a{ model.global_action(state, action) };
+				model.create_action_line(state, action, action_lines[a], action_rhs[a]);
+			}
+			model.create_matrix_line(state, decisions, mat[state], rew[state]);
+		}
+	}
+
+	/*
+		Replaces the line of state by the precomputed one for action, the line of a resolved state stays x = 0.
+	*/
+	void change_decision(linear_systems::var_id state, std::size_t action) {
+		if (model->is_resolved(state)) {
+			return;
+		}
+		const std::size_t a{ model->global_action(state, action) };
+		mat[state] = action_lines[a];
+		rew[state] = action_rhs[a];
+	}
+
+	const linear_systems::matrix& matrix() const {
+		return mat;
+	}
+
+	const linear_systems::matrix_line& line(linear_systems::var_id state) const {
+		return mat[state];
+	}
+
+	const linear_systems::rational_vector& right_hand_side() const {
+		return rew;
+	}
+
+	const linear_systems::id_vector& resolved_variables() const {
+		return resolved;
+	}
+
+	/*
+		@return the unresolved variables in the elimination order given by ordering for the current lines
+	*/
+	linear_systems::id_vector unresolved_variables(linear_systems::variable_ordering ordering) const {
+		linear_systems::id_vector ordered{ unresolved };
+		linear_systems::apply_variable_ordering(ordering, mat, ordered);
+		return ordered;
+	}
+
+};
+
+/*
+	Builds (I - P_sched) x = rew, variable ids are the indices of ordered_variables.
+	@param ordering only changes the order of unresolved, i.e. the elimination order for the solver.
+*/
+inline void create_matrix(const mdp& m, const std::vector<std::string>& ordered_variables, const scheduler_container& cont, linear_systems::matrix& mat, linear_systems::rational_vector& rew, linear_systems::id_vector& unresolved, linear_systems::id_vector& resolved, linear_systems::variable_ordering ordering = linear_systems::variable_ordering::discovery) {
+	// Px = rew
+	// target: xi = 0
+	// others: xj = Pk xk + r 
+	// .....->  (d_j - Pk) x = r
+	//
+	const dense_policy_model model(m, ordered_variables, cont);
+	model.create_matrix(model.make_dense_scheduler(ordered_variables, cont), mat, rew, unresolved, resolved, ordering);
+}
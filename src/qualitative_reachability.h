@@ -0,0 +1,299 @@
+#pragma once
+
+#include "mdp_ops.h"
+#include "linear_system.h"
+
+#include <deque>
+#include <string>
+#include <vector>
+
+/*
+	Qualitative reachability of the target states, only the graph of transitions with positive probability is considered:
+		prob0E:  states where some scheduler reaches the target with probability 0,
+		prob0A:  states where every scheduler reaches the target with probability 0,
+		prob1E:  states where some scheduler reaches the target with probability 1,
+		prob1A:  states where every scheduler reaches the target with probability 1.
+	prob0E, prob0A and prob1A are a constant number of backward searches over the predecessor graph, prob1E iterates such searches at most once per state.
+	All results are per state a flag, states numbered like in the qualitative_graph.
+*/
+
+/*
+	Same layout as dense_policy_model: state s owns the actions [first_action[s], first_action[s + 1]),
+	action a owns the successors [first_transition[a], first_transition[a + 1]).
+*/
+class qualitative_graph {
+	std::vector<std::size_t> first_action;
+	std::vector<std::size_t> first_transition;
+	linear_systems::id_vector successors;
+
+	// predecessor (state, action) pairs of every state:
+	std::vector<std::size_t> first_predecessor;
+	linear_systems::id_vector predecessor_states;
+	std::vector<std::size_t> predecessor_actions;
+
+public:
+
+	qualitative_graph(std::vector<std::size_t> first_action, std::vector<std::size_t> first_transition, linear_systems::id_vector successors) :
+		first_action(std::move(first_action)),
+		first_transition(std::move(first_transition)),
+		successors(std::move(successors))
+	{
+		first_predecessor.assign(count_states() + 1, 0);
+		for (const auto& successor : this->successors) {
+			++first_predecessor[successor + 1];
+		}
+		for (std::size_t s{ 0 }; s < count_states(); ++s) {
+			first_predecessor[s + 1] += first_predecessor[s];
+		}
+		predecessor_states.resize(this->successors.size());
+		predecessor_actions.resize(this->successors.size());
+		std::vector<std::size_t> next_free(first_predecessor.cbegin(), first_predecessor.cend() - 1);
+		for (linear_systems::var_id state{ 0 }; state < count_states(); ++state) {
+			for (std::size_t a{ this->first_action[state] }; a < this->first_action[state + 1]; ++a) {
+				for (std::size_t t{ this->first_transition[a] }; t < this->first_transition[a + 1]; ++t) {
+					const std::size_t slot{ next_free[this->successors[t]]++ };
+					predecessor_states[slot] = state;
+					predecessor_actions[slot] = a;
+				}
+			}
+		}
+	}
+
+	std::size_t count_states() const {
+		return first_action.size() - 1;
+	}
+
+	std::size_t count_all_actions() const {
+		return first_transition.size() - 1;
+	}
+
+	std::size_t actions_begin(linear_systems::var_id state) const {
+		return first_action[state];
+	}
+
+	std::size_t actions_end(linear_systems::var_id state) const {
+		return first_action[state + 1];
+	}
+
+	std::size_t transitions_begin(std::size_t action) const {
+		return first_transition[action];
+	}
+
+	std::size_t transitions_end(std::size_t action) const {
+		return first_transition[action + 1];
+	}
+
+	linear_systems::var_id successor(std::size_t transition) const {
+		return successors[transition];
+	}
+
+	/*
+		predecessors of state are [predecessors_begin(state), predecessors_end(state)), see predecessor_state() and predecessor_action()
+	*/
+	std::size_t predecessors_begin(linear_systems::var_id state) const {
+		return first_predecessor[state];
+	}
+
+	std::size_t predecessors_end(linear_systems::var_id state) const {
+		return first_predecessor[state + 1];
+	}
+
+	linear_systems::var_id predecessor_state(std::size_t predecessor) const {
+		return predecessor_states[predecessor];
+	}
+
+	std::size_t predecessor_action(std::size_t predecessor) const {
+		return predecessor_actions[predecessor];
+	}
+
+};
+
+/*
+	states numbered in the order of m.states, transitions with probability 0 are left out
+	@throws std::out_of_range if m refers to unknown states
+*/
+inline qualitative_graph make_qualitative_graph(const mdp& m) {
+	std::map<std::string, linear_systems::var_id> index;
+	for (const auto& state : m.states) {
+		index.emplace(state, index.size());
+	}
+	std::vector<std::size_t> first_action;
+	std::vector<std::size_t> first_transition{ 0 };
+	linear_systems::id_vector successors;
+	for (const auto& state : m.states) {
+		first_action.push_back(first_transition.size() - 1);
+		const auto found{ m.probabilities.find(state) };
+		if (found == m.probabilities.cend()) {
+			continue;
+		}
+		for (const auto& action_paired_distr : found->second) {
+			for (const auto& next_state_paired_probability : action_paired_distr.second) {
+				if (next_state_paired_probability.second != rational_type(0)) {
+					successors.push_back(index.at(next_state_paired_probability.first));
+				}
+			}
+			first_transition.push_back(successors.size());
+		}
+	}
+	first_action.push_back(first_transition.size() - 1);
+	return qualitative_graph(std::move(first_action), std::move(first_transition), std::move(successors));
+}
+
+/*
+	@return per state in the order of m.states whether it is a target
+*/
+inline std::vector<bool> target_flags(const mdp& m) {
+	std::vector<bool> result;
+	result.reserve(m.states.size());
+	for (const auto& state : m.states) {
+		result.push_back(set_contains(m.targets, state));
+	}
+	return result;
+}
+
+/*
+	@return states that can reach a flagged state with positive probability by some scheduler, i.e. backward reachability over all actions.
+		States flagged in blocked are never entered (but may be starting points).
+*/
+inline std::vector<bool> backward_reachable(const qualitative_graph& graph, const std::vector<bool>& from, const std::vector<bool>& blocked) {
+	std::vector<bool> reached{ from };
+	std::deque<linear_systems::var_id> queue;
+	for (linear_systems::var_id state{ 0 }; state < graph.count_states(); ++state) {
+		if (reached[state]) {
+			queue.push_back(state);
+		}
+	}
+	while (!queue.empty()) {
+		const linear_systems::var_id state{ queue.front() };
+		queue.pop_front();
+		for (std::size_t p{ graph.predecessors_begin(state) }; p < graph.predecessors_end(state); ++p) {
+			const linear_systems::var_id predecessor{ graph.predecessor_state(p) };
+			if (!reached[predecessor] && !blocked[predecessor]) {
+				reached[predecessor] = true;
+				queue.push_back(predecessor);
+			}
+		}
+	}
+	return reached;
+}
+
+inline std::vector<bool> prob0A(const qualitative_graph& graph, const std::vector<bool>& targets) {
+	std::vector<bool> result{ backward_reachable(graph, targets, std::vector<bool>(graph.count_states(), false)) };
+	result.flip();
+	return result;
+}
+
+inline std::vector<bool> prob0E(const qualitative_graph& graph, const std::vector<bool>& targets) {
+	// least fixpoint of the states where every scheduler has a positive probability: targets, and states with actions which all have a successor inside
+	std::vector<bool> positive{ targets };
+	std::vector<std::size_t> remaining_actions(graph.count_states());
+	std::vector<bool> action_hit(graph.count_all_actions(), false);
+	std::deque<linear_systems::var_id> queue;
+	for (linear_systems::var_id state{ 0 }; state < graph.count_states(); ++state) {
+		remaining_actions[state] = graph.actions_end(state) - graph.actions_begin(state);
+		if (positive[state]) {
+			queue.push_back(state);
+		}
+	}
+	while (!queue.empty()) {
+		const linear_systems::var_id state{ queue.front() };
+		queue.pop_front();
+		for (std::size_t p{ graph.predecessors_begin(state) }; p < graph.predecessors_end(state); ++p) {
+			const linear_systems::var_id predecessor{ graph.predecessor_state(p) };
+			const std::size_t action{ graph.predecessor_action(p) };
+			if (positive[predecessor] || action_hit[action]) {
+				continue;
+			}
+			action_hit[action] = true;
+			if (--remaining_actions[predecessor] == 0) {
+				positive[predecessor] = true;
+				queue.push_back(predecessor);
+			}
+		}
+	}
+	positive.flip();
+	return positive;
+}
+
+inline std::vector<bool> prob1E(const qualitative_graph& graph, const std::vector<bool>& targets) {
+	// greatest fixpoint U of: states that can reach the target using only actions that surely stay in U
+	std::vector<bool> candidates{ backward_reachable(graph, targets, std::vector<bool>(graph.count_states(), false)) };
+	while (true) {
+		std::vector<bool> staying(graph.count_all_actions(), true);
+		for (linear_systems::var_id state{ 0 }; state < graph.count_states(); ++state) {
+			for (std::size_t a{ graph.actions_begin(state) }; a < graph.actions_end(state); ++a) {
+				for (std::size_t t{ graph.transitions_begin(a) }; t < graph.transitions_end(a); ++t) {
+					if (!candidates[graph.successor(t)]) {
+						staying[a] = false;
+						break;
+					}
+				}
+			}
+		}
+		std::vector<bool> reached{ targets };
+		std::deque<linear_systems::var_id> queue;
+		for (linear_systems::var_id state{ 0 }; state < graph.count_states(); ++state) {
+			if (reached[state]) {
+				queue.push_back(state);
+			}
+		}
+		while (!queue.empty()) {
+			const linear_systems::var_id state{ queue.front() };
+			queue.pop_front();
+			for (std::size_t p{ graph.predecessors_begin(state) }; p < graph.predecessors_end(state); ++p) {
+				const linear_systems::var_id predecessor{ graph.predecessor_state(p) };
+				if (!reached[predecessor] && candidates[predecessor] && staying[graph.predecessor_action(p)]) {
+					reached[predecessor] = true;
+					queue.push_back(predecessor);
+				}
+			}
+		}
+		if (reached == candidates) {
+			return candidates;
+		}
+		candidates = std::move(reached);
+	}
+}
+
+inline std::vector<bool> prob1A(const qualitative_graph& graph, const std::vector<bool>& targets) {
+	// some scheduler misses the target with positive probability iff it can reach a prob0E state before reaching the target
+	std::vector<bool> result{ backward_reachable(graph, prob0E(graph, targets), targets) };
+	result.flip();
+	return result;
+}
+
+/*
+	States whose accumulated reward is 0 under every scheduler: greatest fixpoint of the targets and
+	the states whose actions all have reward 0 and only successors inside.
+	@param zero_reward per action of graph whether its reward is 0
+	@return the flagged states without the targets
+*/
+inline std::vector<bool> zero_value_states(const qualitative_graph& graph, const std::vector<bool>& targets, const std::vector<bool>& zero_reward) {
+	std::vector<bool> inside(graph.count_states(), false);
+	std::deque<linear_systems::var_id> queue; // states not inside whose predecessors have to be checked
+	for (linear_systems::var_id state{ 0 }; state < graph.count_states(); ++state) {
+		bool all_zero{ graph.actions_begin(state) != graph.actions_end(state) };
+		for (std::size_t a{ graph.actions_begin(state) }; a < graph.actions_end(state); ++a) {
+			all_zero = all_zero && zero_reward[a];
+		}
+		inside[state] = targets[state] || all_zero;
+		if (!inside[state]) {
+			queue.push_back(state);
+		}
+	}
+	while (!queue.empty()) {
+		const linear_systems::var_id state{ queue.front() };
+		queue.pop_front();
+		for (std::size_t p{ graph.predecessors_begin(state) }; p < graph.predecessors_end(state); ++p) {
+			const linear_systems::var_id predecessor{ graph.predecessor_state(p) };
+			if (inside[predecessor] && !targets[predecessor]) {
+				inside[predecessor] = false;
+				queue.push_back(predecessor);
+			}
+		}
+	}
+	for (linear_systems::var_id state{ 0 }; state < graph.count_states(); ++state) {
+		inside[state] = inside[state] && !targets[state];
+	}
+	return inside;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "mdp_ops.h"
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <limits>
+#include <thread>
+#include <vector>
+
+/*
+	Exhaustive enumeration of all schedulers of a scheduler_container, in parallel.
+	The index space [0, number_of_schedulers) is split into contiguous chunks, many more chunks than threads.
+	Every worker thread claims the next unclaimed chunk until none is left,
+	so a thread that got cheap schedulers continues with other chunks instead of waiting for the expensive ones.
+	The results are returned per chunk in index order, so merging them does not depend on the thread timing.
+
+	Two numberings of the schedulers: like operator++ enumerates them (see scheduler_container::assign_index),
+	or as reflected mixed radix Gray code (see gray_code_enumerator), where consecutive schedulers differ in the decision of one state only.
+*/
+
+/*
+	Walks through the schedulers of a scheduler_container in reflected mixed radix Gray code order.
+	The digits are the decisions in the order of sched, the first state is the lowest digit. Digit j of scheduler k is the ordinary digit d_j of k,
+	or b_j - 1 - d_j if the number formed by the higher ordinary digits is odd. So every step moves exactly one decision by one.
+*/
+class gray_code_enumerator {
+	std::vector<std::pair<const std::string*, std::size_t*>> digits; // state, its decision in cont.sched
+	std::vector<std::size_t> radices;
+	std::vector<bool> upwards;
+
+public:
+
+	static constexpr std::size_t NONE{ std::numeric_limits<std::size_t>::max() };
+
+	/*
+		Sets the decisions of cont to scheduler number index, cont must outlive the enumerator and its sched must not be changed elsewhere.
+	*/
+	gray_code_enumerator(scheduler_container& cont, big_int_type index) {
+		for (auto& [state, action_index] : cont.sched) {
+			const std::size_t radix{ cont.available_actions_per_state.at(state).size() };
+			const std::size_t digit{ big_int_type(index % radix).convert_to<std::size_t>() };
+			index /= radix;
+			const bool even{ (index & 1) == 0 };
+			action_index = even ? digit : radix - 1 - digit;
+			digits.emplace_back(&state, &action_index);
+			radices.push_back(radix);
+			upwards.push_back(even);
+		}
+	}
+
+	/*
+		Moves to the next scheduler.
+		@return position of the changed state in sched, NONE if the current scheduler is the last one
+	*/
+	std::size_t next() {
+		for (std::size_t j{ 0 }; j < digits.size(); ++j) {
+			std::size_t& action_index{ *digits[j].second };
+			const bool can_move{ upwards[j] ? action_index + 1 < radices[j] : action_index > 0 };
+			if (!can_move) {
+				continue;
+			}
+			upwards[j] ? ++action_index : --action_index;
+			for (std::size_t i{ 0 }; i < j; ++i) { // all lower digits are at their ends, their next pass goes backwards
+				upwards[i] = !upwards[i];
+			}
+			return j;
+		}
+		return NONE;
+	}
+
+	const std::string& state(std::size_t position) const {
+		return *digits[position].first;
+	}
+
+	std::size_t decision(std::size_t position) const {
+		return *digits[position].second;
+	}
+
+};
+
+/*
+	@param cont scheduler_container after init()
+	@param max_threads upper bound for the number of worker threads
+	@param body(begin, count) evaluates the count schedulers with numbers [begin, begin + count), both big_int_type
+	@return the results of body in chunk order
+*/
+template <class Body>
+inline auto for_each_scheduler_chunk(const scheduler_container& cont, std::size_t max_threads, Body body) -> std::vector<decltype(body(big_int_type(), big_int_type()))> {
+	using result_type = decltype(body(big_int_type(), big_int_type()));
+	constexpr std::size_t CHUNKS_PER_THREAD{ 16 }; // for balancing schedulers of very different costs
+
+	const big_int_type count_schedulers{ scheduler_container(cont).number_of_schedulers().numerator() };
+	const std::size_t count_threads{ std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, std::max<std::size_t>(1, max_threads)) };
+	const std::size_t count_chunks{ count_schedulers < big_int_type(count_threads * CHUNKS_PER_THREAD) ? count_schedulers.convert_to<std::size_t>() : count_threads * CHUNKS_PER_THREAD };
+	const auto chunk_begin = [&](std::size_t chunk) -> big_int_type {
+		return count_schedulers * chunk / count_chunks;
+	};
+
+	std::vector<result_type> results(count_chunks);
+	std::atomic<std::size_t> next_chunk{ 0 };
+	const auto worker = [&]() {
+		for (std::size_t chunk{ next_chunk++ }; chunk < count_chunks; chunk = next_chunk++) {
+			results[chunk] = body(chunk_begin(chunk), chunk_begin(chunk + 1) - chunk_begin(chunk));
+		}
+	};
+
+	std::vector<std::future<void>> the_futures;
+	for (std::size_t thread{ 1 }; thread < std::min(count_threads, count_chunks); ++thread) {
+		the_futures.emplace_back(std::async(std::launch::async, worker));
+	}
+	worker();
+	for (auto& future : the_futures) {
+		future.get();
+	}
+	return results;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "custom_types.h"
+
+#include <nlohmann/json.hpp>
+
+#include <string>
+
+/*
+	Optional operation counters for the linear system solvers.
+	A solver_statistics_scope makes an object the active one for the current thread,
+	the solvers only count if there is an active object, otherwise the counters cost a single pointer check.
+*/
+
+namespace linear_systems {
+
+	inline std::size_t bit_length(const big_int_type& value) {
+		return value == 0 ? 0 : boost::multiprecision::msb(boost::multiprecision::abs(value)) + 1;
+	}
+
+	struct solver_statistics {
+		std::size_t eliminations{ 0 }; // variables resolved / pivots eliminated
+		std::size_t substitutions{ 0 }; // known values put into other lines without merging lines
+		std::size_t row_merges{ 0 };
+		std::size_t fill_in{ 0 }; // entries created by row merges
+		std::size_t primes_used{ 0 }; // multi-modular solving only
+		std::size_t low_rank_updated_lines{ 0 }; // incremental solving only
+		std::size_t refactorizations{ 0 }; // incremental solving only, not counting the initial factorization
+		std::size_t max_numerator_bits{ 0 }; // of all coefficients seen during elimination, exact solving only
+		std::size_t max_denominator_bits{ 0 };
+
+		void record_coefficient(const rational_type& value) {
+			max_numerator_bits = std::max(max_numerator_bits, bit_length(value.numerator()));
+			max_denominator_bits = std::max(max_denominator_bits, bit_length(value.denominator()));
+		}
+
+		void add(const solver_statistics& other) {
+			eliminations += other.eliminations;
+			substitutions += other.substitutions;
+			row_merges += other.row_merges;
+			fill_in += other.fill_in;
+			primes_used += other.primes_used;
+			low_rank_updated_lines += other.low_rank_updated_lines;
+			refactorizations += other.refactorizations;
+			max_numerator_bits = std::max(max_numerator_bits, other.max_numerator_bits);
+			max_denominator_bits = std::max(max_denominator_bits, other.max_denominator_bits);
+		}
+
+		nlohmann::json to_json() const {
+			nlohmann::json j;
+			j["eliminations"] = eliminations;
+			j["substitutions"] = substitutions;
+			j["row_merges"] = row_merges;
+			j["fill_in"] = fill_in;
+			j["primes_used"] = primes_used;
+			j["low_rank_updated_lines"] = low_rank_updated_lines;
+			j["refactorizations"] = refactorizations;
+			j["max_numerator_bits"] = max_numerator_bits;
+			j["max_denominator_bits"] = max_denominator_bits;
+			return j;
+		}
+	};
+
+	/*
+		@return the active statistics object of this thread, nullptr if counting is disabled.
+	*/
+	inline solver_statistics*& active_solver_statistics() {
+		thread_local solver_statistics* active{ nullptr };
+		return active;
+	}
+
+	class solver_statistics_scope {
+		solver_statistics* previous;
+
+	public:
+		/*
+			@param statistics may be nullptr for disabling counting inside the scope.
+		*/
+		explicit solver_statistics_scope(solver_statistics* statistics) : previous(active_solver_statistics()) {
+			active_solver_statistics() = statistics;
+		}
+
+		solver_statistics_scope(const solver_statistics_scope&) = delete;
+		solver_statistics_scope& operator=(const solver_statistics_scope&) = delete;
+
+		~solver_statistics_scope() {
+			active_solver_statistics() = previous;
+		}
+	};
+
+}
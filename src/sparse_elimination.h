@@ -0,0 +1,215 @@
+#pragma once
+
+#include "linear_system.h"
+#include "sparse_rows.h"
+
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+
+/*
+	Sparse gaussian elimination over an arbitrary number type.
+
+	The dependency order solver in linear_system.h is bound to rational_type.
+	The kernels here work for every type providing + - * / and an overload of linear_systems::is_zero(),
+	so the same elimination can run on machine floating point numbers or on residues modulo a prime.
+*/
+
+namespace linear_systems {
+
+	template <class Number, class Converter>
+	generic_matrix<Number> convert_matrix(const matrix& P, Converter convert) {
+		generic_matrix<Number> result(P.size());
+		for (std::size_t i{ 0 }; i < P.size(); ++i) {
+			result[i].reserve(P[i].size());
+			for (const auto& entry : P[i]) {
+				result[i].emplace_back(entry.first, convert(entry.second));
+			}
+		}
+		return result;
+	}
+
+	template <class Number, class Converter>
+	std::vector<Number> convert_vector(const rational_vector& r, Converter convert) {
+		std::vector<Number> result;
+		result.reserve(r.size());
+		std::transform(r.cbegin(), r.cend(), std::back_inserter(result), convert);
+		return result;
+	}
+
+	template <class Float>
+	Float rational_to_floating_point(const rational_type& value) {
+		return value.numerator().template convert_to<Float>() / value.denominator().template convert_to<Float>();
+	}
+
+	/*
+		LU factorization of a sparse quadratic matrix, pivots are taken from the diagonal in a given elimination order.
+		After factorize() succeeded, solve() can be called for as many right hand sides as needed.
+	*/
+	template <class Number>
+	class sparse_factorization {
+		id_vector elimination_order;
+
+		// lower[k]: pairs (i, factor) meaning r_i -= factor * r_k when eliminating x_k
+		std::vector<generic_matrix_line<Number>> lower;
+
+		// upper row k: line k after eliminating all variables before k, only contains x_k and variables eliminated later than k
+		pooled_sparse_rows<Number> upper;
+
+	public:
+
+		/*
+			@param P must be a quadratic matrix, every line needs a diagonal entry.
+			@param elimination_order must be a permutation of all variable ids.
+					A variable eliminated early should not be needed by many lines that are eliminated later.
+					So sources of the dependency graph should come first, for an acyclic system this order causes no fill-in at all.
+			@return false if some pivot became zero, the factorization is unusable then.
+		*/
+		bool factorize(generic_matrix<Number> P, const id_vector& order) {
+			elimination_order = order;
+			lower.assign(P.size(), generic_matrix_line<Number>());
+
+			// lines_using[j]: lines that (possibly) have a non-zero coefficient for x_j, may contain outdated ids.
+			std::vector<id_vector> lines_using(P.size());
+			for (var_id i{ 0 }; i < P.size(); ++i) {
+				for (const auto& entry : P[i]) {
+					if (entry.first != i) {
+						lines_using[entry.first].push_back(i);
+					}
+				}
+			}
+
+			upper = pooled_sparse_rows<Number>(std::move(P));
+
+			std::vector<bool> eliminated(upper.size(), false);
+			id_vector fill_in;
+
+			for (const var_id k : elimination_order) {
+				const std::size_t pivot_position{ upper.find(k, k) };
+				if (pivot_position == upper.npos || is_zero(upper.value(pivot_position))) {
+					return false;
+				}
+				const Number pivot{ upper.value(pivot_position) };
+				auto statistics = active_solver_statistics();
+				if (statistics) {
+					++statistics->eliminations;
+				}
+				const bool only_diagonal{ upper.count_entries(k) == 1 };
+
+				for (const var_id i : lines_using[k]) {
+					if (eliminated[i]) {
+						continue;
+					}
+					const std::size_t x_k_in_line_i{ upper.find(i, k) };
+					if (x_k_in_line_i == upper.npos) {
+						continue; // outdated or duplicate id
+					}
+					const Number factor{ upper.value(x_k_in_line_i) / pivot };
+					lower[k].emplace_back(i, factor);
+
+					if (only_diagonal) { // nothing to merge, typical for acyclic parts
+						upper.erase(i, x_k_in_line_i);
+						if (statistics) {
+							++statistics->substitutions;
+						}
+						continue;
+					}
+					// line_i -= factor * line_k, dropping x_k:
+					fill_in.clear();
+					upper.subtract_multiple_of_row(i, factor, k, k, fill_in);
+					for (const auto& j : fill_in) {
+						lines_using[j].push_back(i);
+					}
+					if (statistics) {
+						++statistics->row_merges;
+						statistics->fill_in += fill_in.size();
+						if constexpr (std::is_same_v<Number, rational_type>) {
+							for (std::size_t position{ upper.begin(i) }; position < upper.end(i); ++position) {
+								statistics->record_coefficient(upper.value(position));
+							}
+						}
+					}
+				}
+				eliminated[k] = true;
+			}
+			return true;
+		}
+
+		/*
+			@param r right hand side, contains the solution afterwards.
+		*/
+		void solve(std::vector<Number>& r) const {
+			// forward: apply the recorded line operations
+			for (const var_id k : elimination_order) {
+				for (const auto& [i, factor] : lower[k]) {
+					r[i] = r[i] - factor * r[k];
+				}
+			}
+			// backward substitution, every line only refers to variables eliminated later than its own one.
+			for (auto k = elimination_order.crbegin(); k != elimination_order.crend(); ++k) {
+				Number accumulated{ r[*k] };
+				Number diagonal{};
+				for (std::size_t position{ upper.begin(*k) }; position < upper.end(*k); ++position) {
+					if (upper.is_erased(position)) {
+						continue;
+					}
+					if (upper.column(position) == *k) {
+						diagonal = upper.value(position);
+					}
+					else {
+						accumulated = accumulated - upper.value(position) * r[upper.column(position)];
+					}
+				}
+				r[*k] = accumulated / diagonal;
+			}
+		}
+
+		std::size_t size() const {
+			return upper.size();
+		}
+
+	};
+
+	/*
+		Factorizes P once, so that several right hand sides can be solved, either exactly (Number = rational_type) or in floating point.
+		Interface of P, unresolved, resolved as for solve_linear_system_dependency_order_optimized.
+	*/
+	template <class Number = rational_type>
+	sparse_factorization<Number> factorize_linear_system(const matrix& P, const id_vector& unresolved, const id_vector& resolved) {
+		id_vector elimination_order{ unresolved };
+		std::copy(resolved.cbegin(), resolved.cend(), std::back_inserter(elimination_order));
+
+		sparse_factorization<Number> factorization;
+		bool success;
+		if constexpr (std::is_same_v<Number, rational_type>) {
+			success = factorization.factorize(P, elimination_order);
+		}
+		else {
+			success = factorization.factorize(convert_matrix<Number>(P, rational_to_floating_point<Number>), elimination_order);
+		}
+		if (!success) {
+			throw linear_system_error("Factorizing linear system: zero pivot in the given elimination order.");
+		}
+		return factorization;
+	}
+
+	/*
+		@param r right hand side, contains the solution afterwards (if successful).
+		@return false if some pivot became zero, r is unchanged then.
+		see sparse_factorization::factorize
+	*/
+	template <class Number>
+	bool solve_linear_system_sparse_elimination(
+		generic_matrix<Number> P,
+		std::vector<Number>& r,
+		const id_vector& elimination_order
+	) {
+		sparse_factorization<Number> factorization;
+		if (!factorization.factorize(std::move(P), elimination_order)) {
+			return false;
+		}
+		factorization.solve(r);
+		return true;
+	}
+
+}
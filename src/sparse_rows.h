@@ -0,0 +1,227 @@
+#pragma once
+
+#include "linear_system_types.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+/*
+	Sparse rows in struct of arrays layout:
+	all column ids of all rows in one contiguous pool, the values in a parallel pool.
+	Each row is a sorted range [begin, end) inside the pools.
+
+	Erasing an entry only sets a tombstone, nothing is moved.
+	Combining two rows merges them into a scratch buffer, the result is written back in place if it fits into the range of the row,
+	otherwise to the end of the pools with some spare capacity, and the old range becomes unused.
+	The pools are compacted when less than a quarter of their slots is in use.
+*/
+
+namespace linear_systems {
+
+	template <class Number>
+	using generic_matrix_entry = std::pair<var_id, Number>;
+
+	template <class Number>
+	using generic_matrix_line = std::vector<generic_matrix_entry<Number>>;
+
+	template <class Number>
+	using generic_matrix = std::vector<generic_matrix_line<Number>>;
+
+	inline bool is_zero(const rational_type& value) {
+		return value == rational_type(0);
+	}
+
+	inline bool is_zero(const long double& value) {
+		return value == 0.0L;
+	}
+
+	inline bool is_zero(const double& value) {
+		return value == 0.0;
+	}
+
+	template <class Number>
+	class pooled_sparse_rows {
+		struct row_range {
+			std::size_t begin;
+			std::size_t end;
+			std::size_t capacity_end; // slots in [end, capacity_end) are reserved for growing the row in place
+			std::size_t live; // entries without tombstone
+		};
+
+		std::vector<var_id> column_pool;
+		std::vector<Number> value_pool;
+		std::vector<char> erased_pool; // tombstones, not std::vector<bool> for cheaper access in the inner loops
+		std::vector<row_range> rows;
+		std::size_t count_live{ 0 };
+
+		// a merged row is built here first, this buffer stays in cache
+		std::vector<var_id> scratch_columns;
+		std::vector<Number> scratch_values;
+
+		/*
+			Moves the scratch row into row i, in place if it fits, otherwise to the end of the pools with twice its size as capacity.
+		*/
+		void store_scratch_row(var_id i) {
+			row_range& row{ rows[i] };
+			const std::size_t length{ scratch_columns.size() };
+			if (row.begin + length > row.capacity_end) {
+				row.begin = column_pool.size();
+				row.capacity_end = row.begin + 2 * length;
+				column_pool.resize(row.capacity_end);
+				value_pool.resize(row.capacity_end);
+				erased_pool.resize(row.capacity_end);
+			}
+			std::copy(scratch_columns.cbegin(), scratch_columns.cend(), column_pool.begin() + row.begin);
+			std::move(scratch_values.begin(), scratch_values.end(), value_pool.begin() + row.begin);
+			std::fill(erased_pool.begin() + row.begin, erased_pool.begin() + row.begin + length, char(false));
+			row.end = row.begin + length;
+			row.live = length;
+		}
+
+	public:
+		static constexpr std::size_t npos{ std::numeric_limits<std::size_t>::max() };
+
+		pooled_sparse_rows() {}
+
+		/*
+			@param P lines do not need to be sorted.
+		*/
+		explicit pooled_sparse_rows(generic_matrix<Number> P) : rows(P.size()) {
+			for (auto& line : P) {
+				std::sort(line.begin(), line.end(), [](const generic_matrix_entry<Number>& l, const generic_matrix_entry<Number>& r) { return l.first < r.first; });
+				count_live += line.size();
+			}
+			column_pool.reserve(count_live);
+			value_pool.reserve(count_live);
+			erased_pool.reserve(count_live);
+			for (var_id i{ 0 }; i < P.size(); ++i) {
+				rows[i].begin = column_pool.size();
+				for (auto& entry : P[i]) {
+					column_pool.push_back(entry.first);
+					value_pool.push_back(std::move(entry.second));
+					erased_pool.push_back(false);
+				}
+				rows[i].end = column_pool.size();
+				rows[i].capacity_end = rows[i].end;
+				rows[i].live = P[i].size();
+			}
+		}
+
+		std::size_t size() const { return rows.size(); }
+
+		std::size_t begin(var_id row) const { return rows[row].begin; }
+		std::size_t end(var_id row) const { return rows[row].end; }
+
+		var_id column(std::size_t position) const { return column_pool[position]; }
+		const Number& value(std::size_t position) const { return value_pool[position]; }
+		Number& value(std::size_t position) { return value_pool[position]; }
+		bool is_erased(std::size_t position) const { return erased_pool[position]; }
+		std::size_t count_entries(var_id row) const { return rows[row].live; }
+
+		/*
+			@return position of the live entry for column inside row, npos if there is none.
+		*/
+		std::size_t find(var_id row, var_id column) const {
+			const auto first = column_pool.cbegin() + rows[row].begin;
+			const auto last = column_pool.cbegin() + rows[row].end;
+			const auto found = std::lower_bound(first, last, column);
+			if (found == last || *found != column) {
+				return npos;
+			}
+			const std::size_t position = found - column_pool.cbegin();
+			return erased_pool[position] ? npos : position;
+		}
+
+		void erase(var_id row, std::size_t position) {
+			erased_pool[position] = true;
+			--rows[row].live;
+			--count_live;
+		}
+
+		/*
+			row_i := row_i - factor * row_j, the entry for dropped_column is removed, other zero entries except the diagonal are removed as well.
+			@param fill_in gets all columns that are new in row_i.
+		*/
+		void subtract_multiple_of_row(var_id i, const Number& factor, var_id j, var_id dropped_column, id_vector& fill_in) {
+			const row_range old_i{ rows[i] };
+			const row_range old_j{ rows[j] };
+			scratch_columns.clear();
+			scratch_values.clear();
+
+			std::size_t p{ old_i.begin };
+			std::size_t q{ old_j.begin };
+			std::size_t live_in_old_i{ 0 };
+			while (true) {
+				while (p < old_i.end && erased_pool[p]) ++p;
+				while (q < old_j.end && erased_pool[q]) ++q;
+				if (p == old_i.end && q == old_j.end) {
+					break;
+				}
+				if (q == old_j.end || (p < old_i.end && column_pool[p] < column_pool[q])) {
+					if (column_pool[p] != dropped_column) {
+						scratch_columns.push_back(column_pool[p]);
+						scratch_values.push_back(std::move(value_pool[p]));
+					}
+					++live_in_old_i;
+					++p;
+					continue;
+				}
+				if (p == old_i.end || column_pool[q] < column_pool[p]) {
+					if (column_pool[q] != dropped_column) {
+						scratch_columns.push_back(column_pool[q]);
+						scratch_values.push_back(-(factor * value_pool[q]));
+						fill_in.push_back(column_pool[q]);
+					}
+					++q;
+					continue;
+				}
+				// same column in both rows
+				if (column_pool[p] != dropped_column) {
+					Number combined{ value_pool[p] - factor * value_pool[q] };
+					if (!is_zero(combined) || column_pool[p] == i) {
+						scratch_columns.push_back(column_pool[p]);
+						scratch_values.push_back(std::move(combined));
+					}
+				}
+				++live_in_old_i;
+				++p;
+				++q;
+			}
+
+			count_live = count_live - live_in_old_i + scratch_columns.size();
+			store_scratch_row(i);
+			if (column_pool.size() > 4 * count_live) {
+				compact();
+			}
+		}
+
+		/*
+			Removes all unused slots and tombstones, row order inside the pools is kept.
+		*/
+		void compact() {
+			std::vector<var_id> new_columns;
+			std::vector<Number> new_values;
+			std::vector<char> new_erased;
+			new_columns.reserve(count_live);
+			new_values.reserve(count_live);
+			new_erased.reserve(count_live);
+			for (auto& row : rows) {
+				const std::size_t new_begin{ new_columns.size() };
+				for (std::size_t position{ row.begin }; position < row.end; ++position) {
+					if (!erased_pool[position]) {
+						new_columns.push_back(column_pool[position]);
+						new_values.push_back(std::move(value_pool[position]));
+						new_erased.push_back(false);
+					}
+				}
+				row = row_range{ new_begin, new_columns.size(), new_columns.size(), new_columns.size() - new_begin };
+			}
+			column_pool = std::move(new_columns);
+			value_pool = std::move(new_values);
+			erased_pool = std::move(new_erased);
+		}
+
+	};
+
+}
@@ -0,0 +1,247 @@
+#pragma once
+
+#include "linear_system.h"
+
+#include <limits>
+#include <set>
+#include <string>
+
+/*
+	Elimination orders for the unresolved variables of a linear system Px = r.
+	Variable ids are never renamed, only the order of the unresolved vector changes.
+	So solutions keep the order of the variables given to create_matrix.
+*/
+
+namespace linear_systems {
+
+	enum class variable_ordering {
+		discovery, // keep the given order
+		scc_topological, // strongly connected components in topological order, reverse Cuthill-McKee inside each component
+		minimum_degree
+	};
+
+	inline std::string to_string(variable_ordering ordering) {
+		switch (ordering) {
+		case variable_ordering::discovery:
+			return "discovery";
+		case variable_ordering::scc_topological:
+			return "scc-topological";
+		case variable_ordering::minimum_degree:
+			return "minimum-degree";
+		}
+		return "unknown";
+	}
+
+	/*
+		@return successors[x] = all unresolved y != x with P_xy != 0, i.e. x depends on y.
+	*/
+	inline std::vector<id_vector> dependency_graph(const matrix& P, const std::vector<bool>& is_unresolved) {
+		std::vector<id_vector> successors(P.size());
+		for (var_id x{ 0 }; x < P.size(); ++x) {
+			if (!is_unresolved[x]) {
+				continue;
+			}
+			for (const auto& entry : P[x]) {
+				if (entry.first != x && is_unresolved[entry.first] && entry.second != rational_type(0)) {
+					successors[x].push_back(entry.first);
+				}
+			}
+		}
+		return successors;
+	}
+
+	/*
+		Tarjan's algorithm without recursion.
+		@return the strongly connected components in reverse topological order, i.e. components without successors first.
+	*/
+	inline std::vector<id_vector> strongly_connected_components(const std::vector<id_vector>& successors, const id_vector& nodes) {
+		constexpr var_id UNVISITED{ std::numeric_limits<var_id>::max() };
+		std::vector<var_id> index(successors.size(), UNVISITED);
+		std::vector<var_id> low_link(successors.size(), 0);
+		std::vector<bool> on_stack(successors.size(), false);
+		id_vector stack;
+		std::vector<id_vector> components;
+		var_id next_index{ 0 };
+
+		std::vector<std::pair<var_id, std::size_t>> call_stack; // node, next successor position
+		for (const auto& root : nodes) {
+			if (index[root] != UNVISITED) {
+				continue;
+			}
+			call_stack.emplace_back(root, 0);
+			while (!call_stack.empty()) {
+				auto& [v, position] = call_stack.back();
+				if (position == 0) {
+					index[v] = next_index;
+					low_link[v] = next_index;
+					++next_index;
+					stack.push_back(v);
+					on_stack[v] = true;
+				}
+				if (position < successors[v].size()) {
+					const var_id w{ successors[v][position] };
+					++position;
+					if (index[w] == UNVISITED) {
+						call_stack.emplace_back(w, 0);
+					}
+					else if (on_stack[w]) {
+						low_link[v] = std::min(low_link[v], index[w]);
+					}
+					continue;
+				}
+				if (low_link[v] == index[v]) {
+					components.emplace_back();
+					var_id w;
+					do {
+						w = stack.back();
+						stack.pop_back();
+						on_stack[w] = false;
+						components.back().push_back(w);
+					} while (w != v);
+				}
+				const var_id finished{ v };
+				call_stack.pop_back();
+				if (!call_stack.empty()) {
+					low_link[call_stack.back().first] = std::min(low_link[call_stack.back().first], low_link[finished]);
+				}
+			}
+		}
+		return components;
+	}
+
+	/*
+		Reverse Cuthill-McKee order of the nodes of one component with respect to the undirected version of the graph.
+		@param in_component marks exactly the nodes of component
+	*/
+	inline id_vector reverse_cuthill_mckee(const std::vector<id_vector>& neighbors, const id_vector& component, const std::vector<bool>& in_component) {
+		const auto degree = [&](var_id v) {
+			return std::count_if(neighbors[v].cbegin(), neighbors[v].cend(), [&](var_id w) { return in_component[w]; });
+		};
+		id_vector sorted_by_degree{ component };
+		std::stable_sort(sorted_by_degree.begin(), sorted_by_degree.end(), [&](var_id l, var_id r) { return degree(l) < degree(r); });
+
+		std::set<var_id> visited;
+		id_vector order;
+		for (const auto& start : sorted_by_degree) { // one start node per connected part
+			if (!visited.insert(start).second) {
+				continue;
+			}
+			std::size_t head{ order.size() };
+			order.push_back(start);
+			while (head < order.size()) {
+				id_vector next;
+				for (const auto& w : neighbors[order[head]]) {
+					if (in_component[w] && visited.insert(w).second) {
+						next.push_back(w);
+					}
+				}
+				std::stable_sort(next.begin(), next.end(), [&](var_id l, var_id r) { return degree(l) < degree(r); });
+				std::copy(next.cbegin(), next.cend(), std::back_inserter(order));
+				++head;
+			}
+		}
+		std::reverse(order.begin(), order.end());
+		return order;
+	}
+
+	/*
+		@return undirected neighbors, without duplicates
+	*/
+	inline std::vector<id_vector> undirected_graph(const std::vector<id_vector>& successors) {
+		std::vector<std::set<var_id>> neighbor_sets(successors.size());
+		for (var_id x{ 0 }; x < successors.size(); ++x) {
+			for (const auto& y : successors[x]) {
+				neighbor_sets[x].insert(y);
+				neighbor_sets[y].insert(x);
+			}
+		}
+		std::vector<id_vector> neighbors(successors.size());
+		for (var_id x{ 0 }; x < successors.size(); ++x) {
+			neighbors[x].assign(neighbor_sets[x].cbegin(), neighbor_sets[x].cend());
+		}
+		return neighbors;
+	}
+
+	/*
+		Variables that depend on others come first (they can be eliminated without fill-in as far as the graph is acyclic).
+	*/
+	inline id_vector order_scc_topological(const matrix& P, const id_vector& unresolved, const std::vector<bool>& is_unresolved) {
+		const auto successors{ dependency_graph(P, is_unresolved) };
+		const auto neighbors{ undirected_graph(successors) };
+		auto components{ strongly_connected_components(successors, unresolved) };
+		std::reverse(components.begin(), components.end());
+
+		id_vector order;
+		order.reserve(unresolved.size());
+		std::vector<bool> in_component(P.size(), false);
+		for (const auto& component : components) {
+			if (component.size() == 1) {
+				order.push_back(component.front());
+				continue;
+			}
+			for (const auto& v : component) {
+				in_component[v] = true;
+			}
+			const id_vector component_order{ reverse_cuthill_mckee(neighbors, component, in_component) };
+			std::copy(component_order.cbegin(), component_order.cend(), std::back_inserter(order));
+			for (const auto& v : component) {
+				in_component[v] = false;
+			}
+		}
+		return order;
+	}
+
+	/*
+		Greedy minimum degree on the undirected graph, eliminating a variable connects all its remaining neighbors.
+	*/
+	inline id_vector order_minimum_degree(const matrix& P, const id_vector& unresolved, const std::vector<bool>& is_unresolved) {
+		const auto neighbors{ undirected_graph(dependency_graph(P, is_unresolved)) };
+		std::vector<std::set<var_id>> elimination_graph(P.size());
+		std::set<std::pair<std::size_t, var_id>> by_degree;
+		for (const auto& v : unresolved) {
+			elimination_graph[v].insert(neighbors[v].cbegin(), neighbors[v].cend());
+			by_degree.emplace(elimination_graph[v].size(), v);
+		}
+
+		id_vector order;
+		order.reserve(unresolved.size());
+		while (!by_degree.empty()) {
+			const var_id v{ by_degree.begin()->second };
+			by_degree.erase(by_degree.begin());
+			order.push_back(v);
+			const id_vector remaining_neighbors(elimination_graph[v].cbegin(), elimination_graph[v].cend());
+			for (const auto& w : remaining_neighbors) {
+				by_degree.erase(std::make_pair(elimination_graph[w].size(), w));
+				elimination_graph[w].erase(v);
+				for (const auto& u : remaining_neighbors) {
+					if (u != w) {
+						elimination_graph[w].insert(u);
+					}
+				}
+				by_degree.emplace(elimination_graph[w].size(), w);
+			}
+			elimination_graph[v].clear();
+		}
+		return order;
+	}
+
+	/*
+		@param unresolved is reordered according to ordering
+	*/
+	inline void apply_variable_ordering(variable_ordering ordering, const matrix& P, id_vector& unresolved) {
+		if (ordering == variable_ordering::discovery) {
+			return;
+		}
+		std::vector<bool> is_unresolved(P.size(), false);
+		for (const auto& v : unresolved) {
+			is_unresolved[v] = true;
+		}
+		if (ordering == variable_ordering::scc_topological) {
+			unresolved = order_scc_topological(P, unresolved, is_unresolved);
+		}
+		else {
+			unresolved = order_minimum_degree(P, unresolved, is_unresolved);
+		}
+	}
+
+}
@@ -0,0 +1,162 @@
+#include "gtest/gtest.h"
+
+#include "../src/end_components.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+	using distribution = std::map<std::string, rational_type>;
+
+	void add_action(mdp& m, const std::string& state, const std::string& action, const distribution& distr, const rational_type& reward) {
+		m.actions.insert(action);
+		m.probabilities[state][action] = distr;
+		m.rewards[state][action] = reward;
+	}
+
+	/*
+		m0 -> m1 -> m2 -> m0 by z with reward 0, a component whose exits to t have rewards 1 at m0 (x), 2 at m1 (y) and 6 at m2 (w),
+		so the optimal value is 6 in the whole component and m0 has to go through m1 to reach the exit of m2.
+		trap1 <-> trap2 by l with reward 0 is an end component without exit.
+		s leads into the component or to t, the initial state m1 is a member of the component.
+	*/
+	mdp make_example() {
+		mdp m;
+		m.states = { "m0", "m1", "m2", "s", "t", "trap1", "trap2" };
+		m.initial = "m1";
+		m.targets = { "t" };
+		add_action(m, "m0", "z", { { "m1", rational_type(1) } }, rational_type(0));
+		add_action(m, "m0", "x", { { "t", rational_type(1) } }, rational_type(1));
+		add_action(m, "m1", "z", { { "m2", rational_type(1) } }, rational_type(0));
+		add_action(m, "m1", "y", { { "t", rational_type(1) } }, rational_type(2));
+		add_action(m, "m2", "z", { { "m0", rational_type(1) } }, rational_type(0));
+		add_action(m, "m2", "w", { { "t", rational_type(1) } }, rational_type(6));
+		add_action(m, "s", "a", { { "m2", rational_type(1, 2) }, { "t", rational_type(1, 2) } }, rational_type(1));
+		add_action(m, "trap1", "l", { { "trap2", rational_type(1) } }, rational_type(0));
+		add_action(m, "trap2", "l", { { "trap1", rational_type(1) } }, rational_type(0));
+		return m;
+	}
+
+	/*
+		@return per action of make_qualitative_graph(m) whether it has reward 0 and its state is no target
+	*/
+	std::vector<bool> zero_reward_actions(const mdp& m) {
+		std::vector<bool> result;
+		for (const auto& state : m.states) {
+			const auto found{ m.probabilities.find(state) };
+			if (found == m.probabilities.cend()) {
+				continue;
+			}
+			for (const auto& action_paired_distr : found->second) {
+				result.push_back(!m.targets.count(state) && m.rewards.at(state).at(action_paired_distr.first) == rational_type(0));
+			}
+		}
+		return result;
+	}
+
+}
+
+TEST(maximal_end_components, finds_components_with_and_without_exit) {
+	const mdp m{ make_example() };
+	std::vector<bool> in_end_component;
+	const auto components{ maximal_end_components(make_qualitative_graph(m), zero_reward_actions(m), in_end_component) };
+
+	// states 0 m0, 1 m1, 2 m2, 5 trap1, 6 trap2
+	std::vector<linear_systems::id_vector> sorted{ components };
+	std::sort(sorted.begin(), sorted.end());
+	EXPECT_EQ(sorted, std::vector<linear_systems::id_vector>({ { 0, 1, 2 }, { 5, 6 } }));
+	// actions in order: m0 x, m0 z, m1 y, m1 z, m2 w, m2 z, s a, trap1 l, trap2 l
+	EXPECT_EQ(in_end_component, std::vector<bool>({ false, true, false, true, false, true, false, true, true }));
+}
+
+TEST(maximal_end_components, refines_components_until_no_action_leaves_them) {
+	/*
+		p -> q by a and q -> p or r by b, both with reward 0, r -> t with reward 1:
+		{ p, q } is strongly connected, but b leaves it, then q has no action left, then a leaves the rest { p }.
+		u loops with reward 0.
+	*/
+	mdp m;
+	m.states = { "p", "q", "r", "t", "u" };
+	m.initial = "p";
+	m.targets = { "t" };
+	add_action(m, "p", "a", { { "q", rational_type(1) } }, rational_type(0));
+	add_action(m, "q", "b", { { "p", rational_type(1, 2) }, { "r", rational_type(1, 2) } }, rational_type(0));
+	add_action(m, "r", "c", { { "t", rational_type(1) } }, rational_type(1));
+	add_action(m, "u", "d", { { "u", rational_type(1) } }, rational_type(0));
+
+	std::vector<bool> in_end_component;
+	const auto components{ maximal_end_components(make_qualitative_graph(m), zero_reward_actions(m), in_end_component) };
+	EXPECT_EQ(components, std::vector<linear_systems::id_vector>({ { 4 } }));
+	EXPECT_EQ(in_end_component, std::vector<bool>({ false, false, false, true }));
+}
+
+TEST(collapse_zero_reward_end_components, collapses_components_with_exit_into_their_smallest_state) {
+	const mdp original{ make_example() };
+	mdp m{ original };
+	const collapsed_end_components collapsed{ collapse_zero_reward_end_components(m) };
+
+	EXPECT_EQ(collapsed.components, end_component_mapping({ { "m0", { "m0", "m1", "m2" } } }));
+	EXPECT_EQ(collapsed.original.states, original.states);
+	EXPECT_EQ(collapsed.original.probabilities, original.probabilities);
+
+	EXPECT_EQ(m.states, std::set<std::string>({ "m0", "s", "t", "trap1", "trap2" }));
+	EXPECT_EQ(m.initial, "m0");
+	EXPECT_EQ(m.targets, original.targets);
+
+	// the exits of all members, the ones of other members renamed, the actions inside the component dropped:
+	const distribution to_t{ { "t", rational_type(1) } };
+	EXPECT_EQ(m.probabilities.at("m0"), (std::map<std::string, distribution>({ { "x", to_t }, { "y@m1", to_t }, { "w@m2", to_t } })));
+	EXPECT_EQ(m.rewards.at("m0"), (std::map<std::string, rational_type>({ { "x", rational_type(1) }, { "y@m1", rational_type(2) }, { "w@m2", rational_type(6) } })));
+	EXPECT_TRUE(m.actions.count("y@m1"));
+	EXPECT_TRUE(m.actions.count("w@m2"));
+	EXPECT_FALSE(m.probabilities.count("m1"));
+	EXPECT_FALSE(m.rewards.count("m2"));
+
+	// transitions into members go to the representative:
+	EXPECT_EQ(m.probabilities.at("s").at("a"), distribution({ { "m0", rational_type(1, 2) }, { "t", rational_type(1, 2) } }));
+
+	// the trap has no exit and stays as it is:
+	EXPECT_EQ(m.probabilities.at("trap1"), original.probabilities.at("trap1"));
+	EXPECT_EQ(m.probabilities.at("trap2"), original.probabilities.at("trap2"));
+}
+
+TEST(collapse_zero_reward_end_components, leaves_an_mdp_without_such_components_unchanged) {
+	mdp m{ make_example() };
+	m.rewards["m2"]["z"] = rational_type(1); // breaks the cycle of reward 0
+	m.rewards["trap1"]["l"] = rational_type(1);
+	const mdp original{ m };
+	const collapsed_end_components collapsed{ collapse_zero_reward_end_components(m) };
+	EXPECT_TRUE(collapsed.components.empty());
+	EXPECT_EQ(m.states, original.states);
+	EXPECT_EQ(m.probabilities, original.probabilities);
+	EXPECT_EQ(m.initial, original.initial);
+}
+
+TEST(expand_optimal_actions, routes_members_through_other_members_to_the_optimal_exit) {
+	mdp m{ make_example() };
+	const collapsed_end_components collapsed{ collapse_zero_reward_end_components(m) };
+
+	const std::map<std::string, std::vector<std::string>> optimal{ { "m0", { "w@m2" } }, { "s", { "a" } } };
+	const auto expanded{ expand_optimal_actions(collapsed, optimal) };
+	EXPECT_EQ(expanded, (std::map<std::string, std::vector<std::string>>({
+		{ "m0", { "z" } }, // distance 2: over m1
+		{ "m1", { "z" } }, // distance 1
+		{ "m2", { "w" } }, // the optimal exit
+		{ "s", { "a" } } })));
+}
+
+TEST(expand_optimal_actions, keeps_every_optimal_exit_of_the_members) {
+	mdp m{ make_example() };
+	m.rewards["m0"]["x"] = rational_type(6); // m0 and m2 both have an optimal exit now
+	const collapsed_end_components collapsed{ collapse_zero_reward_end_components(m) };
+
+	const auto expanded{ expand_optimal_actions(collapsed, { { "m0", { "x", "w@m2" } } }) };
+	EXPECT_EQ(expanded, (std::map<std::string, std::vector<std::string>>({
+		{ "m0", { "x" } },
+		{ "m1", { "z" } }, // to m2, the exit of m0 is two steps away
+		{ "m2", { "w" } } })));
+}
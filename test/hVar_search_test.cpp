@@ -0,0 +1,81 @@
+#include "gtest/gtest.h"
+
+#include "../src/hVar_search.h"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+	/*
+		s0 -a-> s1 (reward 1), s0 -b-> t or s1 (reward 2)
+		s1 -c-> t (reward 3), s1 -d-> t or s0 (reward 1), s1 -e-> t (reward 3, the same as c, so there are ties)
+	*/
+	mdp make_small_mdp() {
+		mdp m;
+		m.states = { "s0", "s1", "t" };
+		m.actions = { "a", "b", "c", "d", "e" };
+		m.initial = "s0";
+		m.targets = { "t" };
+		m.probabilities["s0"]["a"]["s1"] = rational_type(1);
+		m.probabilities["s0"]["b"]["t"] = rational_type(1, 2);
+		m.probabilities["s0"]["b"]["s1"] = rational_type(1, 2);
+		m.probabilities["s1"]["c"]["t"] = rational_type(1);
+		m.probabilities["s1"]["d"]["t"] = rational_type(1, 2);
+		m.probabilities["s1"]["d"]["s0"] = rational_type(1, 2);
+		m.probabilities["s1"]["e"]["t"] = rational_type(1);
+		m.rewards["s0"]["a"] = rational_type(1);
+		m.rewards["s0"]["b"] = rational_type(2);
+		m.rewards["s1"]["c"] = rational_type(3);
+		m.rewards["s1"]["d"] = rational_type(1);
+		m.rewards["s1"]["e"] = rational_type(3);
+		return m;
+	}
+
+}
+
+TEST(check_all_exponential_schedulers_for_hVar, gray_code_search_finds_the_best_schedulers_of_odometer_enumeration) {
+	const mdp m{ make_small_mdp() };
+	const rational_type cut_level{ 4 };
+
+	for (const rational_type& lambda : { rational_type(0), rational_type(1, 10), rational_type(2) }) {
+		std::vector<std::string> ordered_variables;
+		std::map<std::string, std::pair<std::string, rational_type>> augmented_state_to_pair;
+		const mdp unfolded{ stupid_unfold(m, cut_level, ordered_variables, augmented_state_to_pair) };
+
+		const auto [best, best_mu, best_schedulers] = check_all_exponential_schedulers_for_hVar(m, unfolded, lambda, cut_level, ordered_variables);
+
+		// the reference: every scheduler in the order of operator++, evaluated from scratch:
+		scheduler_container cont;
+		cont.init(unfolded);
+		linear_systems::solver_configuration solver;
+		solver.backend = linear_systems::solver_backend::dependency_order;
+		solver.backend_given = true;
+		hVar_full_evaluator evaluator(m, unfolded, lambda, cut_level, ordered_variables, cont, solver);
+		bool first{ true };
+		rational_type expected_best;
+		std::map<scheduler_container::scheduler, rational_type> expected_schedulers; // to their mu
+		do {
+			const auto [mu, mu_minus_hVar] = evaluator.evaluate();
+			if (first || mu_minus_hVar > expected_best) {
+				first = false;
+				expected_best = mu_minus_hVar;
+				expected_schedulers.clear();
+			}
+			if (mu_minus_hVar == expected_best) {
+				expected_schedulers[cont.sched] = mu;
+			}
+		} while (++cont);
+
+		EXPECT_EQ(best, expected_best) << "lambda " << lambda;
+		ASSERT_EQ(best_schedulers.size(), best_mu.size());
+		std::map<scheduler_container::scheduler, rational_type> found_schedulers;
+		for (std::size_t i{ 0 }; i < best_schedulers.size(); ++i) {
+			EXPECT_TRUE(found_schedulers.emplace(best_schedulers[i].sched, best_mu[i]).second) << "scheduler found twice";
+		}
+		EXPECT_EQ(found_schedulers, expected_schedulers) << "lambda " << lambda;
+		EXPECT_GT(found_schedulers.size(), 1);
+	}
+}
@@ -0,0 +1,195 @@
+#include "gtest/gtest.h"
+
+#include "../src/interval_iteration.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace {
+
+	const std::vector<std::string> ORDERED_VARIABLES{ "s0", "s1", "t" };
+
+	/*
+		s0 -a-> s1 (reward 1), s0 -b-> t or s1 (reward 2)
+		s1 -c-> t (reward 3), s1 -d-> t or s0 (reward 1), s1 -e-> t (reward 3),
+		optimal values 4 at s0 by a and 3 at s1, where c, d and e are all optimal.
+		@param sign multiplies all rewards
+	*/
+	mdp make_small_mdp(const rational_type& sign) {
+		mdp m;
+		m.states = { "s0", "s1", "t" };
+		m.actions = { "a", "b", "c", "d", "e" };
+		m.initial = "s0";
+		m.targets = { "t" };
+		m.probabilities["s0"]["a"]["s1"] = rational_type(1);
+		m.probabilities["s0"]["b"]["t"] = rational_type(1, 2);
+		m.probabilities["s0"]["b"]["s1"] = rational_type(1, 2);
+		m.probabilities["s1"]["c"]["t"] = rational_type(1);
+		m.probabilities["s1"]["d"]["t"] = rational_type(1, 2);
+		m.probabilities["s1"]["d"]["s0"] = rational_type(1, 2);
+		m.probabilities["s1"]["e"]["t"] = rational_type(1);
+		m.rewards["s0"]["a"] = sign * rational_type(1);
+		m.rewards["s0"]["b"] = sign * rational_type(2);
+		m.rewards["s1"]["c"] = sign * rational_type(3);
+		m.rewards["s1"]["d"] = sign * rational_type(1);
+		m.rewards["s1"]["e"] = sign * rational_type(3);
+		return m;
+	}
+
+	std::size_t action_index(const scheduler_container& cont, const std::string& state, const std::string& action) {
+		const auto& actions{ cont.available_actions_per_state.at(state) };
+		return std::find(actions.cbegin(), actions.cend(), action) - actions.cbegin();
+	}
+
+	/*
+		@return the optimal values as maximum over the values of all deterministic schedulers, every scheduler reaches the target
+	*/
+	std::vector<rational_type> optimal_values_by_enumeration(const dense_policy_model& model) {
+		std::vector<rational_type> best;
+		dense_policy_model::dense_scheduler decisions(model.count_states(), 0);
+		while (true) {
+			linear_systems::matrix mat;
+			linear_systems::rational_vector rew;
+			linear_systems::id_vector unresolved;
+			linear_systems::id_vector resolved;
+			model.create_matrix(decisions, mat, rew, unresolved, resolved, linear_systems::variable_ordering::discovery);
+			solve_linear_system_dependency_order_optimized(mat, rew, unresolved, resolved);
+			if (best.empty()) {
+				best = rew;
+			}
+			for (linear_systems::var_id state{ 0 }; state < model.count_states(); ++state) {
+				best[state] = std::max(best[state], rew[state]);
+			}
+			linear_systems::var_id state{ 0 };
+			for (; state < model.count_states(); ++state) {
+				if (++decisions[state] < model.count_actions(state)) {
+					break;
+				}
+				decisions[state] = 0;
+			}
+			if (state == model.count_states()) {
+				return best;
+			}
+		}
+	}
+
+}
+
+TEST(ceil_to_big_int, rounds_up_negative_and_fractional_values) {
+	EXPECT_EQ(ceil_to_big_int(0.0L), big_int_type(0));
+	EXPECT_EQ(ceil_to_big_int(2.0L), big_int_type(2));
+	EXPECT_EQ(ceil_to_big_int(2.5L), big_int_type(3));
+	EXPECT_EQ(ceil_to_big_int(0.25L), big_int_type(1));
+	EXPECT_EQ(ceil_to_big_int(-0.25L), big_int_type(0));
+	EXPECT_EQ(ceil_to_big_int(-2.0L), big_int_type(-2));
+	EXPECT_EQ(ceil_to_big_int(-2.5L), big_int_type(-2));
+	EXPECT_EQ(ceil_to_big_int(std::ldexp(1.0L, 70)), big_int_type(1) << 70);
+	EXPECT_EQ(ceil_to_big_int(std::ldexp(1.0L, 70) + std::ldexp(1.0L, 10)), (big_int_type(1) << 70) + 1024);
+	EXPECT_EQ(ceil_to_big_int(1e-30), big_int_type(1));
+	EXPECT_EQ(ceil_to_big_int(-1e-30), big_int_type(0));
+	EXPECT_EQ(ceil_to_big_int(12345.000001), big_int_type(12346));
+}
+
+TEST(exact_rational, is_the_exact_binary_value) {
+	EXPECT_EQ(exact_rational(0.0L), rational_type(0));
+	EXPECT_EQ(exact_rational(-0.0L), rational_type(0));
+	EXPECT_EQ(exact_rational(3.0L), rational_type(3));
+	EXPECT_EQ(exact_rational(0.5L), rational_type(1, 2));
+	EXPECT_EQ(exact_rational(-0.75L), rational_type(-3, 4));
+	EXPECT_EQ(exact_rational(-6.125), rational_type(-49, 8));
+	EXPECT_EQ(exact_rational(std::ldexp(1.0L, -80)), rational_type(1, big_int_type(1) << 80));
+	EXPECT_EQ(exact_rational(0.1), rational_type(3602879701896397, big_int_type(36028797018963968)));
+	for (const long double value : { 1.0L / 3.0L, -2.0L / 7.0L, 1e20L, -1e-20L }) {
+		EXPECT_EQ(linear_systems::rational_to_floating_point<long double>(exact_rational(value)), value);
+		EXPECT_EQ(exact_rational(value) < rational_type(0), value < 0);
+	}
+}
+
+TEST(expected_steps_bound, passes_its_exact_check) {
+	const mdp m{ make_small_mdp(rational_type(1)) };
+	scheduler_container cont;
+	cont.init(m);
+	const dense_policy_model model(m, ORDERED_VARIABLES, cont);
+	const approximate_policy_model<long double> approximate(model);
+
+	const std::vector<big_int_type> bound{ expected_steps_bound(model, approximate, linear_systems::variable_ordering::discovery) };
+	ASSERT_EQ(bound.size(), model.count_states());
+	EXPECT_EQ(bound[2], big_int_type(0));
+	for (linear_systems::var_id state{ 0 }; state < 2; ++state) {
+		for (std::size_t action{ 0 }; action < model.count_actions(state); ++action) {
+			const std::size_t a{ model.global_action(state, action) };
+			rational_type expected{ 1 };
+			for (std::size_t t{ model.transitions_begin(a) }; t < model.transitions_end(a); ++t) {
+				expected += model.probability(t) * rational_type(bound[model.successor(t)]);
+			}
+			EXPECT_GE(rational_type(bound[state]), expected) << ORDERED_VARIABLES[state] << " " << action;
+		}
+	}
+}
+
+TEST(expected_steps_bound, fails_if_some_scheduler_does_not_reach_the_target) {
+	mdp m{ make_small_mdp(rational_type(1)) };
+	m.actions.insert("f");
+	m.probabilities["s1"]["f"]["s1"] = rational_type(1);
+	m.rewards["s1"]["f"] = rational_type(1);
+	scheduler_container cont;
+	cont.init(m);
+	const dense_policy_model model(m, ORDERED_VARIABLES, cont);
+	const approximate_policy_model<long double> approximate(model);
+	EXPECT_THROW(expected_steps_bound(model, approximate, linear_systems::variable_ordering::discovery), interval_iteration_error);
+}
+
+TEST(interval_iteration, bounds_enclose_the_optimal_values_within_the_precision) {
+	for (const rational_type& sign : { rational_type(1), rational_type(-1) }) {
+		const mdp m{ make_small_mdp(sign) };
+		scheduler_container cont;
+		cont.init(m);
+		const dense_policy_model model(m, ORDERED_VARIABLES, cont);
+		const std::vector<rational_type> optimal{ optimal_values_by_enumeration(model) };
+		if (sign > 0) {
+			ASSERT_EQ(optimal, std::vector<rational_type>({ rational_type(4), rational_type(3), rational_type(0) }));
+		}
+
+		interval_iteration_configuration configuration;
+		configuration.precision = rational_type(1, 1000);
+		const auto result{ interval_iteration(model, configuration, linear_systems::variable_ordering::scc_topological) };
+		EXPECT_LE(result.exact_max_gap, configuration.precision) << "sign " << sign;
+		for (linear_systems::var_id state{ 0 }; state < model.count_states(); ++state) {
+			EXPECT_LE(result.exact_lower[state], optimal[state]) << ORDERED_VARIABLES[state] << " sign " << sign;
+			EXPECT_GE(result.exact_upper[state], optimal[state]) << ORDERED_VARIABLES[state] << " sign " << sign;
+			EXPECT_LE(result.exact_upper[state] - result.exact_lower[state], configuration.precision) << ORDERED_VARIABLES[state] << " sign " << sign;
+		}
+		// the target starts and stays at exactly 0, not -0:
+		EXPECT_FALSE(std::signbit(result.lower[2])) << "sign " << sign;
+		EXPECT_FALSE(std::signbit(result.upper[2])) << "sign " << sign;
+	}
+}
+
+TEST(possibly_optimal_actions, never_drops_a_tied_optimal_action) {
+	const mdp m{ make_small_mdp(rational_type(1)) };
+	scheduler_container cont;
+	cont.init(m);
+	const dense_policy_model model(m, ORDERED_VARIABLES, cont);
+
+	// loose bounds after few sweeps as in the action elimination, and tight ones:
+	for (const std::size_t sweeps : { 1, 2, 4, 64, 1000000 }) {
+		interval_iteration_configuration configuration;
+		configuration.max_sweeps_per_component = sweeps;
+		const auto candidates{ possibly_optimal_actions(model, interval_iteration(model, configuration, linear_systems::variable_ordering::discovery)) };
+		ASSERT_EQ(candidates.size(), model.count_states());
+		const auto contains = [&](const std::string& state, const std::string& action) {
+			const auto& actions{ candidates[std::find(ORDERED_VARIABLES.cbegin(), ORDERED_VARIABLES.cend(), state) - ORDERED_VARIABLES.cbegin()] };
+			return std::find(actions.cbegin(), actions.cend(), action_index(cont, state, action)) != actions.cend();
+		};
+		EXPECT_TRUE(contains("s0", "a")) << sweeps << " sweeps";
+		EXPECT_TRUE(contains("s1", "c")) << sweeps << " sweeps";
+		EXPECT_TRUE(contains("s1", "d")) << sweeps << " sweeps";
+		EXPECT_TRUE(contains("s1", "e")) << sweeps << " sweeps";
+		EXPECT_TRUE(candidates[2].empty());
+		if (sweeps == 1000000) {
+			EXPECT_FALSE(contains("s0", "b")) << "the bounds are tight enough to rule out b";
+		}
+	}
+}
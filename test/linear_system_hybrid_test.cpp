@@ -0,0 +1,91 @@
+#include "gtest/gtest.h"
+
+#include "../src/logger.h"
+#include "../src/linear_system.h"
+#include "../src/linear_system_hybrid.h"
+#include "linear_system_test_systems.h"
+
+#include <cmath>
+#include <limits>
+
+namespace {
+
+	using namespace linear_systems;
+	using namespace linear_system_test_systems;
+
+	const long double TOLERANCE{ std::pow(std::numeric_limits<long double>::epsilon(), 0.75L) };
+
+}
+
+TEST(reconstruct_rational_by_continued_fraction, finds_fractions_with_small_denominators) {
+	const big_int_type max_denominator{ big_int_type(1) << 40 };
+	for (const rational_type& value : { rational_type(0), rational_type(5), rational_type(-3), rational_type(1, 3), rational_type(-7, 4), rational_type(22, 7), rational_type(-1000001, 999983), rational_type(1, 1 << 30) }) {
+		rational_type result;
+		ASSERT_TRUE(reconstruct_rational_by_continued_fraction(rational_to_floating_point<long double>(value), result, max_denominator, TOLERANCE)) << value;
+		EXPECT_EQ(result, value);
+	}
+}
+
+TEST(reconstruct_rational_by_continued_fraction, stops_at_the_first_convergent_within_the_tolerance) {
+	rational_type result;
+	ASSERT_TRUE(reconstruct_rational_by_continued_fraction(3.14159265358979323846L, result, big_int_type(1) << 40, 1e-6L));
+	EXPECT_EQ(result, rational_type(355, 113));
+}
+
+TEST(reconstruct_rational_by_continued_fraction, fails_beyond_the_maximal_denominator) {
+	rational_type result;
+	EXPECT_FALSE(reconstruct_rational_by_continued_fraction(rational_to_floating_point<long double>(rational_type(1, 1001)), result, big_int_type(1000), TOLERANCE));
+	EXPECT_TRUE(reconstruct_rational_by_continued_fraction(rational_to_floating_point<long double>(rational_type(1, 1001)), result, big_int_type(1001), TOLERANCE));
+	EXPECT_FALSE(reconstruct_rational_by_continued_fraction(std::numeric_limits<long double>::infinity(), result, big_int_type(1000), TOLERANCE));
+	EXPECT_FALSE(reconstruct_rational_by_continued_fraction(std::numeric_limits<long double>::quiet_NaN(), result, big_int_type(1000), TOLERANCE));
+	EXPECT_FALSE(reconstruct_rational_by_continued_fraction(1e30L, result, big_int_type(1000), TOLERANCE));
+}
+
+/*
+	x0 = x1 / 2 + 1/3 + 10^-20, x1 = 0, x2 = x0, x3 = x4 / 4 + 1, x4 = 2:
+	the floating point value of x0 is reconstructed as 1/3, which violates the line of x0, x3 is reconstructed correctly.
+*/
+TEST(solve_linear_system_hybrid_floating_point, solves_lines_violated_by_the_floating_point_solution_exactly) {
+	const rational_type tiny{ rational_type(1, big_int_type("100000000000000000000")) };
+	const matrix P{
+		{ { 0, rational_type(1) }, { 1, rational_type(-1, 2) } },
+		{ { 1, rational_type(1) } },
+		{ { 0, rational_type(-1) }, { 2, rational_type(1) } },
+		{ { 3, rational_type(1) }, { 4, rational_type(-1, 4) } },
+		{ { 4, rational_type(1) } }
+	};
+	const rational_vector r{ rational_type(1, 3) + tiny, rational_type(0), rational_type(0), rational_type(1), rational_type(2) };
+	const id_vector unresolved{ 0, 2, 3 };
+	const id_vector resolved{ 1, 4 };
+
+	// the situation of the fallback:
+	rational_type reconstructed;
+	ASSERT_TRUE(reconstruct_rational_by_continued_fraction(rational_to_floating_point<long double>(r[0]), reconstructed, big_int_type(1) << 40, TOLERANCE));
+	ASSERT_EQ(reconstructed, rational_type(1, 3));
+	const rational_vector x_reconstructed{ rational_type(1, 3), rational_type(0), rational_type(1, 3), rational_type(3, 2), rational_type(2) };
+	EXPECT_EQ(lines_violated_by(P, r, x_reconstructed, std::vector<bool>(P.size(), false)), id_vector{ 0 });
+	EXPECT_EQ(variables_depending_on(P, { 0 }), std::vector<bool>({ true, false, true, false, false }));
+
+	rational_vector x{ r };
+	solve_linear_system_hybrid_floating_point(P, x, unresolved, resolved);
+	EXPECT_EQ(x, solve_directly(P, r, unresolved, resolved));
+	EXPECT_EQ(x[0], rational_type(1, 3) + tiny);
+	EXPECT_EQ(x[2], rational_type(1, 3) + tiny);
+	EXPECT_EQ(x[3], rational_type(3, 2));
+}
+
+TEST(solve_linear_system_hybrid_floating_point, solves_variables_without_reconstruction_exactly) {
+	const matrix P{
+		{ { 0, rational_type(1) }, { 1, rational_type(-1, 3) } },
+		{ { 1, rational_type(1) }, { 0, rational_type(-1, 5) } },
+		{ { 2, rational_type(1) } }
+	};
+	const rational_vector r{ rational_type(1, 7), rational_type(2, 11), rational_type(4) };
+	const id_vector unresolved{ 0, 1 };
+	const id_vector resolved{ 2 };
+
+	// the solution 235/1078, 243/1078 has denominators beyond the bound, so no value is reconstructed:
+	rational_vector x{ r };
+	solve_linear_system_hybrid_floating_point(P, x, unresolved, resolved, big_int_type(10));
+	EXPECT_EQ(x, solve_directly(P, r, unresolved, resolved));
+}
@@ -0,0 +1,154 @@
+#include "gtest/gtest.h"
+
+#include "../src/logger.h"
+#include "../src/linear_system.h"
+#include "../src/linear_system_incremental.h"
+#include "linear_system_test_systems.h"
+
+namespace {
+
+	using namespace linear_systems;
+	using namespace linear_system_test_systems;
+
+	constexpr std::size_t COUNT_UNRESOLVED{ 30 };
+	constexpr std::size_t COUNT_RESOLVED{ 3 };
+
+	/*
+		Line of the policy system x_i = sum_j p_j x_j + r_i of a random action of state i,
+		it leaves to a resolved state with positive probability, so every such system is regular.
+	*/
+	matrix_line random_policy_line(var_id i, std::mt19937& random) {
+		std::uniform_int_distribution<std::size_t> target(0, COUNT_UNRESOLVED + COUNT_RESOLVED - 1);
+		std::uniform_int_distribution<std::size_t> resolved_target(COUNT_UNRESOLVED, COUNT_UNRESOLVED + COUNT_RESOLVED - 1);
+		std::map<var_id, rational_type> successors;
+		successors[resolved_target(random)] += rational_type(1, 4);
+		successors[target(random)] += rational_type(1, 2);
+		successors[target(random)] += rational_type(1, 4);
+		successors[i] -= rational_type(1);
+		matrix_line line;
+		for (const auto& [j, p] : successors) {
+			if (p != rational_type(0)) {
+				line.emplace_back(j, p);
+			}
+		}
+		return line;
+	}
+
+	rational_type random_reward(std::mt19937& random) {
+		return rational_type(std::uniform_int_distribution<int>(-5, 5)(random), std::uniform_int_distribution<int>(1, 3)(random));
+	}
+
+	/*
+		Policy system with a random action per unresolved state and random rewards.
+	*/
+	test_system random_policy_system(std::mt19937& random) {
+		test_system system;
+		for (var_id i{ 0 }; i < COUNT_UNRESOLVED; ++i) {
+			system.P.push_back(random_policy_line(i, random));
+			system.r.push_back(-random_reward(random));
+			system.unresolved.push_back(i);
+		}
+		for (var_id i{ COUNT_UNRESOLVED }; i < COUNT_UNRESOLVED + COUNT_RESOLVED; ++i) {
+			system.P.push_back(matrix_line{ { i, rational_type(1) } });
+			system.r.push_back(random_reward(random));
+			system.resolved.push_back(i);
+		}
+		return system;
+	}
+
+	void expect_same_solution(incremental_linear_system& system, const test_system& reference) {
+		rational_vector x;
+		system.solve(x);
+		EXPECT_EQ(x, reference.solve_directly());
+	}
+
+}
+
+TEST(incremental_linear_system, solves_like_the_direct_solver_after_replaced_lines) {
+	std::mt19937 random(17);
+	test_system reference{ random_policy_system(random) };
+	incremental_linear_system system;
+	system.factorize(reference.P, reference.r, reference.unresolved, reference.resolved);
+	expect_same_solution(system, reference);
+
+	std::uniform_int_distribution<var_id> line(0, COUNT_UNRESOLVED - 1);
+	for (std::size_t round{ 0 }; round < 40; ++round) {
+		const var_id i{ line(random) };
+		reference.P[i] = random_policy_line(i, random);
+		reference.r[i] = -random_reward(random);
+		system.replace_line(i, reference.P[i], reference.r[i]);
+		if (round % 3 == 0) {
+			expect_same_solution(system, reference);
+		}
+	}
+	expect_same_solution(system, reference);
+}
+
+TEST(incremental_linear_system, refactorizes_beyond_the_threshold_only) {
+	std::mt19937 random(4);
+	test_system reference{ random_policy_system(random) };
+	incremental_linear_system system;
+	system.factorize(reference.P, reference.r, reference.unresolved, reference.resolved);
+	ASSERT_LT(system.max_changed_lines(), COUNT_UNRESOLVED);
+
+	var_id i{ 0 };
+	for (; i < system.max_changed_lines(); ++i) {
+		reference.P[i] = random_policy_line(i, random);
+		system.replace_line(i, reference.P[i], reference.r[i]);
+		expect_same_solution(system, reference);
+		EXPECT_EQ(system.count_changed_lines(), i + 1) << "low rank update expected";
+	}
+
+	reference.P[i] = random_policy_line(i, random);
+	system.replace_line(i, reference.P[i], reference.r[i]);
+	EXPECT_EQ(system.count_changed_lines(), system.max_changed_lines() + 1);
+	expect_same_solution(system, reference);
+	EXPECT_EQ(system.count_changed_lines(), 0) << "refactorization expected";
+
+	// the new factorization is the base of the next updates:
+	reference.P[0] = random_policy_line(0, random);
+	system.replace_line(0, reference.P[0], reference.r[0]);
+	expect_same_solution(system, reference);
+	EXPECT_EQ(system.count_changed_lines(), 1);
+}
+
+TEST(incremental_linear_system, a_line_replaced_by_its_base_line_is_no_change) {
+	std::mt19937 random(5);
+	test_system reference{ random_policy_system(random) };
+	incremental_linear_system system;
+	system.factorize(reference.P, reference.r, reference.unresolved, reference.resolved);
+
+	const matrix_line base{ reference.P[3] };
+	system.replace_line(3, random_policy_line(3, random), reference.r[3]);
+	EXPECT_EQ(system.count_changed_lines(), 1);
+	system.replace_line(3, base, reference.r[3]);
+	EXPECT_EQ(system.count_changed_lines(), 0);
+	expect_same_solution(system, reference);
+}
+
+TEST(incremental_linear_system, singular_capacitance_falls_back_to_refactorization) {
+	std::mt19937 random(6);
+	test_system reference{ random_policy_system(random) };
+	incremental_linear_system system;
+	system.factorize(reference.P, reference.r, reference.unresolved, reference.resolved);
+
+	// states 0 and 1 only move to each other, so the current system is singular, and with it the capacitance matrix:
+	const matrix_line base_0{ reference.P[0] };
+	const matrix_line base_1{ reference.P[1] };
+	system.replace_line(0, matrix_line{ { 0, rational_type(-1) }, { 1, rational_type(1) } }, reference.r[0]);
+	system.replace_line(1, matrix_line{ { 0, rational_type(1) }, { 1, rational_type(-1) } }, reference.r[1]);
+	rational_vector x;
+	EXPECT_THROW(system.solve(x), linear_system_error);
+
+	// the failed refactorization keeps the old one usable:
+	system.replace_line(0, base_0, reference.r[0]);
+	system.replace_line(1, base_1, reference.r[1]);
+	expect_same_solution(system, reference);
+
+	// a regular system reached through the same lines is solved again:
+	reference.P[0] = random_policy_line(0, random);
+	reference.P[1] = random_policy_line(1, random);
+	system.replace_line(0, reference.P[0], reference.r[0]);
+	system.replace_line(1, reference.P[1], reference.r[1]);
+	expect_same_solution(system, reference);
+}
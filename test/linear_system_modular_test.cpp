@@ -0,0 +1,96 @@
+#include "gtest/gtest.h"
+
+#include "../src/logger.h"
+#include "../src/linear_system.h"
+#include "../src/linear_system_modular.h"
+#include "linear_system_test_systems.h"
+
+namespace {
+
+	using namespace linear_systems;
+	using namespace linear_system_test_systems;
+
+	/* u with u == a / b (mod M) */
+	big_int_type residue_of(const rational_type& value, const big_int_type& M, const big_int_type& euler_phi_of_M) {
+		big_int_type u{ value.numerator() % M };
+		if (u < 0) {
+			u += M;
+		}
+		const big_int_type exponent{ euler_phi_of_M - 1 };
+		const big_int_type inverse{ boost::multiprecision::powm(value.denominator(), exponent, M) };
+		return big_int_type(u * inverse % M);
+	}
+
+}
+
+TEST(reconstruct_rational_from_residue, finds_small_fractions) {
+	const big_int_type p{ 2147483647 };
+	const big_int_type q{ 2147483629 };
+	const big_int_type M{ p * q };
+	const big_int_type phi{ (p - 1) * (q - 1) };
+
+	for (const rational_type& value : { rational_type(0), rational_type(1), rational_type(-1), rational_type(3, 7), rational_type(-22, 9), rational_type(1, 65536), rational_type(-1000003, 999983), rational_type(123456789, 987654321 ) }) {
+		rational_type result;
+		ASSERT_TRUE(reconstruct_rational_from_residue(residue_of(value, M, phi), M, result)) << value;
+		EXPECT_EQ(result, value);
+	}
+}
+
+TEST(reconstruct_rational_from_residue, rejects_fractions_beyond_the_bound) {
+	const big_int_type M{ 2147483647 };
+	const big_int_type phi{ M - 1 };
+	const big_int_type bound{ 32767 }; // floor(sqrt(M / 2)), fractions within are unique
+
+	const auto expect_within_bound_or_not_found = [&](const big_int_type& u) {
+		rational_type result;
+		if (reconstruct_rational_from_residue(u, M, result)) {
+			EXPECT_LE(boost::multiprecision::abs(result.numerator()), bound) << u;
+			EXPECT_LE(result.denominator(), bound) << u;
+			EXPECT_EQ(residue_of(result, M, phi), u); // some other small fraction with the same residue
+		}
+	};
+	for (const rational_type& value : { rational_type(1, 1000003), rational_type(1000003, 7), rational_type(-99991, 99989), rational_type(32768), rational_type(1, 32768) }) {
+		rational_type result;
+		if (reconstruct_rational_from_residue(residue_of(value, M, phi), M, result)) {
+			EXPECT_NE(result, value);
+		}
+		expect_within_bound_or_not_found(residue_of(value, M, phi));
+	}
+	std::mt19937 random(26);
+	std::uniform_int_distribution<std::int64_t> residue(0, 2147483646);
+	for (std::size_t i{ 0 }; i < 2000; ++i) {
+		expect_within_bound_or_not_found(big_int_type(residue(random)));
+	}
+}
+
+TEST(solve_linear_system_multi_modular, solves_like_the_exact_solver) {
+	std::mt19937 random(27);
+	for (unsigned digits : { 1u, 3u, 12u, 40u }) {
+		const test_system system{ random_system(20, 4, digits, random) };
+		rational_vector x{ system.r };
+		solve_linear_system_multi_modular(system.P, x, system.unresolved, system.resolved);
+		EXPECT_EQ(x, system.solve_directly()) << digits << " digits";
+	}
+}
+
+TEST(solve_linear_system_multi_modular, needs_several_batches_of_primes_for_large_numbers) {
+	std::mt19937 random(28);
+	const test_system system{ random_system(12, 2, 60, random) };
+	solver_statistics statistics;
+	rational_vector x{ system.r };
+	{
+		solver_statistics_scope scope(&statistics);
+		solve_linear_system_multi_modular(system.P, x, system.unresolved, system.resolved);
+	}
+	EXPECT_EQ(x, system.solve_directly());
+	EXPECT_GT(statistics.primes_used, std::max<std::size_t>(4, std::thread::hardware_concurrency()));
+	EXPECT_GE(statistics.eliminations, statistics.primes_used); // counted by the workers
+}
+
+TEST(solve_linear_system_multi_modular, falls_back_to_the_exact_solver) {
+	std::mt19937 random(29);
+	const test_system system{ random_system(10, 2, 30, random) };
+	rational_vector x{ system.r };
+	solve_linear_system_multi_modular(system.P, x, system.unresolved, system.resolved, 1);
+	EXPECT_EQ(x, system.solve_directly());
+}
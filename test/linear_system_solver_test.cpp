@@ -0,0 +1,57 @@
+#include "gtest/gtest.h"
+
+#include "../src/logger.h"
+#include "../src/linear_system_solver.h"
+
+namespace {
+
+	using namespace linear_systems;
+
+	linear_system_metrics make_metrics(std::size_t count_nontrivial_sccs, std::size_t largest_scc, std::size_t numerator_bits, std::size_t denominator_bits) {
+		linear_system_metrics metrics;
+		metrics.count_nontrivial_sccs = count_nontrivial_sccs;
+		metrics.largest_scc = largest_scc;
+		metrics.max_numerator_bits = numerator_bits;
+		metrics.max_denominator_bits = denominator_bits;
+		return metrics;
+	}
+
+}
+
+TEST(select_solver_backend, acyclic_systems_use_dependency_order) {
+	EXPECT_EQ(select_solver_backend(make_metrics(0, 1, 2, 2)), solver_backend::dependency_order);
+	EXPECT_EQ(select_solver_backend(make_metrics(0, 1, 900, 900)), solver_backend::dependency_order);
+}
+
+TEST(select_solver_backend, decides_by_component_size_and_bit_lengths) {
+	EXPECT_EQ(select_solver_backend(make_metrics(1, 4, 3, 4)), solver_backend::hybrid_floating_point); // 28 estimated bits
+	EXPECT_EQ(select_solver_backend(make_metrics(1, 4, 10, 10)), solver_backend::dependency_order); // 80 estimated bits
+	EXPECT_EQ(select_solver_backend(make_metrics(1, 4, 40, 40)), solver_backend::multi_modular); // 320 estimated bits
+	EXPECT_EQ(select_solver_backend(make_metrics(2, 16, 2, 2)), solver_backend::multi_modular); // large component
+}
+
+TEST(select_solver_backend, uses_the_given_thresholds) {
+	solver_selection_thresholds thresholds;
+	thresholds.max_solution_bits_for_hybrid = 0;
+	EXPECT_EQ(select_solver_backend(make_metrics(1, 4, 3, 4), thresholds), solver_backend::dependency_order);
+	thresholds.min_solution_bits_for_modular = 20;
+	EXPECT_EQ(select_solver_backend(make_metrics(1, 4, 3, 4), thresholds), solver_backend::multi_modular);
+	thresholds.min_solution_bits_for_modular = 1000;
+	thresholds.min_scc_for_modular = 100;
+	EXPECT_EQ(select_solver_backend(make_metrics(2, 16, 20, 20), thresholds), solver_backend::dependency_order);
+}
+
+TEST(compute_linear_system_metrics, measures_components_and_bit_lengths) {
+	const matrix P{
+		{ { 0, rational_type(1) }, { 1, rational_type(-1, 2) } },
+		{ { 1, rational_type(1) }, { 0, rational_type(-3, 4) }, { 2, rational_type(-1, 8) } },
+		{ { 2, rational_type(1) } }
+	};
+	const rational_vector r{ rational_type(5), rational_type(0), rational_type(-1000, 3) };
+	const linear_system_metrics metrics{ compute_linear_system_metrics(P, r, { 0, 1 }) };
+	EXPECT_EQ(metrics.count_nontrivial_sccs, 1);
+	EXPECT_EQ(metrics.largest_scc, 2);
+	EXPECT_EQ(metrics.max_numerator_bits, 10);
+	EXPECT_EQ(metrics.max_denominator_bits, 4);
+	EXPECT_EQ(estimated_solution_bits(metrics), 28);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "../src/linear_system.h"
+
+#include <map>
+#include <random>
+
+/*
+	Linear systems shared by the solver tests, solved by the exact dependency order solver for reference.
+*/
+namespace linear_system_test_systems {
+
+	using namespace linear_systems;
+
+	inline rational_vector solve_directly(const matrix& P, const rational_vector& r, const id_vector& unresolved, const id_vector& resolved) {
+		rational_vector x{ r };
+		solve_linear_system_dependency_order_optimized(P, x, unresolved, resolved);
+		return x;
+	}
+
+	struct test_system {
+		matrix P;
+		rational_vector r;
+		id_vector unresolved;
+		id_vector resolved;
+
+		rational_vector solve_directly() const {
+			return linear_system_test_systems::solve_directly(P, r, unresolved, resolved);
+		}
+	};
+
+	/*
+		Regular system with random rationals: x_i - sum_j p_ij x_j = r_i with sum_j |p_ij| < 1 for the first count_unresolved variables,
+		x_i = r_i for the others.
+		@param digits number of decimal digits of the denominators
+	*/
+	inline test_system random_system(std::size_t count_unresolved, std::size_t count_resolved, unsigned digits, std::mt19937& random) {
+		big_int_type denominator_bound{ 1 };
+		for (unsigned i{ 0 }; i < digits; ++i) {
+			denominator_bound *= 10;
+		}
+		const auto random_big = [&](const big_int_type& bound) -> big_int_type { // not auto, that would return an expression template referring to value
+			big_int_type value{ 0 };
+			for (big_int_type b{ 1 }; b < bound; b *= 1000) {
+				value = value * 1000 + std::uniform_int_distribution<int>(0, 999)(random);
+			}
+			return value % bound;
+		};
+		test_system system;
+		const std::size_t n{ count_unresolved + count_resolved };
+		std::uniform_int_distribution<var_id> variable(0, n - 1);
+		for (var_id i{ 0 }; i < n; ++i) {
+			const big_int_type denominator{ random_big(denominator_bound) + 1 };
+			system.r.push_back(rational_type(random_big(denominator_bound) - denominator_bound / 2, denominator));
+			if (i >= count_unresolved) {
+				system.P.push_back(matrix_line{ { i, rational_type(1) } });
+				system.resolved.push_back(i);
+				continue;
+			}
+			std::map<var_id, rational_type> line{ { i, rational_type(1) } };
+			for (std::size_t k{ 0 }; k < 3; ++k) {
+				line[variable(random)] -= rational_type(random_big(denominator), denominator * 4);
+			}
+			system.P.emplace_back(line.cbegin(), line.cend());
+			system.unresolved.push_back(i);
+		}
+		return system;
+	}
+
+}
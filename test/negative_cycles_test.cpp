@@ -0,0 +1,143 @@
+#include "gtest/gtest.h"
+
+#include "../src/negative_cycles.h"
+
+#include <random>
+
+namespace {
+
+	void add_action(mdp& m, const std::string& state, const std::string& action, const rational_type& reward, const std::map<std::string, rational_type>& distribution) {
+		m.states.insert(state);
+		m.actions.insert(action);
+		m.probabilities[state][action] = distribution;
+		m.rewards[state][action] = reward;
+		for (const auto& [successor, probability] : distribution) {
+			m.states.insert(successor);
+			m.probabilities[successor];
+			m.rewards[successor];
+		}
+	}
+
+	/* s0 -a-> s1 -b-> s0 with rewards 1 and b_reward, s1 -c-> t */
+	mdp make_loop(const rational_type& b_reward) {
+		mdp m;
+		m.initial = "s0";
+		m.targets = { "t" };
+		add_action(m, "s0", "a", rational_type(1), { { "s1", rational_type(1) } });
+		add_action(m, "s1", "b", b_reward, { { "s0", rational_type(1, 2) }, { "t", rational_type(1, 2) } });
+		add_action(m, "s1", "c", rational_type(0), { { "t", rational_type(1) } });
+		return m;
+	}
+
+	/*
+		@return true if cycle is a closed walk in the graph of calc_delta_max_state_wise with the given accumulated reward
+	*/
+	bool is_valid_witness(const mdp& m, bool ignore_target_states, const reward_cycle& cycle) {
+		if (cycle.states.empty() || cycle.states.size() != cycle.actions.size()) {
+			return false;
+		}
+		rational_type accumulated{ 0 };
+		for (std::size_t i{ 0 }; i < cycle.states.size(); ++i) {
+			const std::string& state{ cycle.states[i] };
+			const std::string& successor{ cycle.states[(i + 1) % cycle.states.size()] };
+			if (ignore_target_states && set_contains(m.targets, state)) {
+				return false;
+			}
+			const auto& distribution{ m.probabilities.at(state).at(cycle.actions[i]) };
+			if (distribution.find(successor) == distribution.cend()) {
+				return false;
+			}
+			accumulated += m.rewards.at(state).at(cycle.actions[i]);
+		}
+		return accumulated == cycle.accumulated_reward;
+	}
+
+	bool delta_max_finds_negative_loop(const mdp& m, bool ignore_target_states) {
+		try {
+			calc_delta_max_state_wise<false>(m, ignore_target_states, true);
+		}
+		catch (const found_negative_loop&) {
+			return true;
+		}
+		return false;
+	}
+
+}
+
+TEST(find_negative_cycle, finds_a_negative_cycle_with_a_valid_witness) {
+	const mdp m{ make_loop(rational_type(-3)) };
+	reward_cycle cycle;
+	ASSERT_TRUE(find_negative_cycle(m, true, cycle));
+	EXPECT_TRUE(is_valid_witness(m, true, cycle)) << to_string(cycle);
+	EXPECT_EQ(cycle.accumulated_reward, rational_type(-2));
+	EXPECT_THROW(check_no_negative_cycle(m, true), found_negative_loop);
+}
+
+TEST(find_negative_cycle, accepts_a_zero_mean_cycle) {
+	const mdp m{ make_loop(rational_type(-1)) };
+	reward_cycle cycle;
+	EXPECT_FALSE(find_negative_cycle(m, true, cycle));
+	EXPECT_NO_THROW(check_no_negative_cycle(m, true));
+	EXPECT_FALSE(delta_max_finds_negative_loop(m, true));
+}
+
+TEST(find_negative_cycle, finds_the_negative_cycle_among_others) {
+	mdp m{ make_loop(rational_type(5)) };
+	// a second component with a positive and a negative cycle through the same state:
+	add_action(m, "s1", "d", rational_type(0), { { "u0", rational_type(1) } });
+	add_action(m, "u0", "e", rational_type(2), { { "u1", rational_type(1) } });
+	add_action(m, "u1", "f", rational_type(2), { { "u0", rational_type(1) } });
+	add_action(m, "u1", "g", rational_type(-1), { { "u2", rational_type(1) } });
+	add_action(m, "u2", "h", rational_type(-2), { { "u1", rational_type(1) }, { "t", rational_type(0) } });
+	reward_cycle cycle;
+	ASSERT_TRUE(find_negative_cycle(m, true, cycle));
+	EXPECT_TRUE(is_valid_witness(m, true, cycle)) << to_string(cycle);
+	EXPECT_EQ(cycle.accumulated_reward, rational_type(-3));
+}
+
+TEST(find_negative_cycle, ignores_cycles_leaving_target_states_on_request) {
+	mdp m{ make_loop(rational_type(0)) };
+	add_action(m, "t", "back", rational_type(-5), { { "s0", rational_type(1) } });
+	reward_cycle cycle;
+	EXPECT_FALSE(find_negative_cycle(m, true, cycle));
+	ASSERT_TRUE(find_negative_cycle(m, false, cycle));
+	EXPECT_TRUE(is_valid_witness(m, false, cycle)) << to_string(cycle);
+}
+
+TEST(find_negative_cycle, agrees_with_calc_delta_max_state_wise) {
+	std::mt19937 random(44);
+	std::uniform_int_distribution<int> reward(-3, 4);
+	std::size_t count_found{ 0 };
+	for (std::size_t round{ 0 }; round < 200; ++round) {
+		const std::size_t count_states{ std::uniform_int_distribution<std::size_t>(1, 6)(random) };
+		std::uniform_int_distribution<std::size_t> state(0, count_states);
+		mdp m;
+		m.initial = "s0";
+		const std::string target{ "s" + std::to_string(count_states) };
+		m.targets = { target };
+		m.states.insert(target);
+		m.probabilities[target];
+		m.rewards[target];
+		for (std::size_t s{ 0 }; s < count_states; ++s) {
+			const std::size_t count_actions{ std::uniform_int_distribution<std::size_t>(1, 3)(random) };
+			for (std::size_t a{ 0 }; a < count_actions; ++a) {
+				std::map<std::string, rational_type> distribution;
+				distribution["s" + std::to_string(state(random))] += rational_type(1, 2);
+				distribution["s" + std::to_string(state(random))] += rational_type(1, 2);
+				add_action(m, "s" + std::to_string(s), "a" + std::to_string(a), rational_type(reward(random)), distribution);
+			}
+		}
+		for (bool ignore_target_states : { true, false }) {
+			reward_cycle cycle;
+			const bool found{ find_negative_cycle(m, ignore_target_states, cycle) };
+			EXPECT_EQ(found, delta_max_finds_negative_loop(m, ignore_target_states)) << "round " << round;
+			if (found) {
+				++count_found;
+				EXPECT_TRUE(is_valid_witness(m, ignore_target_states, cycle)) << to_string(cycle);
+				EXPECT_LT(cycle.accumulated_reward, rational_type(0));
+			}
+		}
+	}
+	EXPECT_GT(count_found, 40); // both cases are covered
+	EXPECT_LT(count_found, 360);
+}
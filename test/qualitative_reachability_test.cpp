@@ -0,0 +1,107 @@
+#include "gtest/gtest.h"
+
+#include "../src/qualitative_reachability.h"
+
+#include <vector>
+
+namespace {
+
+	using successor_lists = std::vector<std::vector<linear_systems::id_vector>>; // per state, per action its successors
+
+	qualitative_graph make_graph(const successor_lists& states) {
+		std::vector<std::size_t> first_action{ 0 };
+		std::vector<std::size_t> first_transition{ 0 };
+		linear_systems::id_vector successors;
+		for (const auto& actions : states) {
+			for (const auto& action : actions) {
+				successors.insert(successors.end(), action.cbegin(), action.cend());
+				first_transition.push_back(successors.size());
+			}
+			first_action.push_back(first_transition.size() - 1);
+		}
+		return qualitative_graph(std::move(first_action), std::move(first_transition), std::move(successors));
+	}
+
+	std::vector<bool> flags(std::size_t count, const linear_systems::id_vector& flagged) {
+		std::vector<bool> result(count, false);
+		for (const auto& i : flagged) {
+			result[i] = true;
+		}
+		return result;
+	}
+
+	/*
+		target 5, trap 3;
+		0 chooses between a risky way over 1 and a sure one over 2, 4 can loop forever;
+		6 -> 7 -> 8 reach the target from every state, but 8 falls into the trap with positive probability, so prob1E needs a second round to drop 6.
+	*/
+	const successor_lists EXAMPLE{
+		{ { 1 }, { 2 } },
+		{ { 5, 3 } },
+		{ { 5 } },
+		{ { 3 } },
+		{ { 0 }, { 4 } },
+		{},
+		{ { 5, 7 } },
+		{ { 8 } },
+		{ { 3, 5 } }
+	};
+
+}
+
+TEST(qualitative_reachability, prob0A_is_the_set_of_states_not_reaching_the_target) {
+	const qualitative_graph graph{ make_graph(EXAMPLE) };
+	EXPECT_EQ(prob0A(graph, flags(9, { 5 })), flags(9, { 3 }));
+}
+
+TEST(qualitative_reachability, prob0E_contains_states_with_a_scheduler_avoiding_the_target) {
+	const qualitative_graph graph{ make_graph(EXAMPLE) };
+	EXPECT_EQ(prob0E(graph, flags(9, { 5 })), flags(9, { 3, 4 }));
+}
+
+TEST(qualitative_reachability, prob1E_contains_states_with_a_scheduler_surely_reaching_the_target) {
+	const qualitative_graph graph{ make_graph(EXAMPLE) };
+	EXPECT_EQ(prob1E(graph, flags(9, { 5 })), flags(9, { 0, 2, 4, 5 }));
+}
+
+TEST(qualitative_reachability, prob1A_contains_states_where_every_scheduler_surely_reaches_the_target) {
+	const qualitative_graph graph{ make_graph(EXAMPLE) };
+	EXPECT_EQ(prob1A(graph, flags(9, { 5 })), flags(9, { 2, 5 }));
+}
+
+TEST(qualitative_reachability, prob1E_keeps_a_cycle_that_surely_reaches_the_target) {
+	// 0 reaches the target 2 with probability 1/2 per visit and otherwise moves to 1, which can go back to 0 or into the trap 3:
+	const qualitative_graph graph{ make_graph({ { { 2, 1 } }, { { 0 }, { 3 } }, {}, { { 3 } } }) };
+	const std::vector<bool> targets{ flags(4, { 2 }) };
+	EXPECT_EQ(prob1E(graph, targets), flags(4, { 0, 1, 2 }));
+	EXPECT_EQ(prob1A(graph, targets), flags(4, { 2 }));
+	EXPECT_EQ(prob0E(graph, targets), flags(4, { 1, 3 }));
+}
+
+TEST(qualitative_reachability, zero_value_states_are_closed_under_zero_reward_actions) {
+	/*
+		0 -> 1 -> target 7 with reward 0, 2 has an action with reward 1, 3 leads to 2,
+		4 loops with reward 0, 5 has no action and is no target, 6 leads to 5
+	*/
+	const qualitative_graph graph{ make_graph({ { { 1 } }, { { 7 } }, { { 7 }, { 7 } }, { { 2 } }, { { 4 } }, {}, { { 5 } }, {} }) };
+	// actions in order: 0a, 1a, 2a, 2b, 3a, 4a, 6a
+	const std::vector<bool> zero_reward{ true, true, true, false, true, true, true };
+	EXPECT_EQ(zero_value_states(graph, flags(8, { 7 }), zero_reward), flags(8, { 0, 1, 4 }));
+}
+
+TEST(qualitative_reachability, make_qualitative_graph_leaves_out_transitions_with_probability_0) {
+	mdp m;
+	m.states = { "s", "t", "u" };
+	m.initial = "s";
+	m.targets = { "t" };
+	m.probabilities["s"]["a"]["t"] = rational_type(1);
+	m.probabilities["s"]["a"]["u"] = rational_type(0);
+	m.probabilities["u"]["b"]["u"] = rational_type(1);
+	const qualitative_graph graph{ make_qualitative_graph(m) };
+	ASSERT_EQ(graph.count_states(), 3);
+	ASSERT_EQ(graph.count_all_actions(), 2);
+	EXPECT_EQ(graph.transitions_end(0) - graph.transitions_begin(0), 1);
+	EXPECT_EQ(graph.successor(graph.transitions_begin(0)), 1);
+	EXPECT_EQ(target_flags(m), flags(3, { 1 }));
+	EXPECT_EQ(prob1A(graph, target_flags(m)), flags(3, { 0, 1 }));
+}
@@ -0,0 +1,98 @@
+#include "gtest/gtest.h"
+
+#include "../src/scheduler_enumeration.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+	scheduler_container make_container(const std::vector<std::size_t>& radices) {
+		scheduler_container cont;
+		for (std::size_t i{ 0 }; i < radices.size(); ++i) {
+			const std::string state{ "s" + std::to_string(i) };
+			for (std::size_t a{ 0 }; a < radices[i]; ++a) {
+				cont.available_actions_per_state[state].push_back("a" + std::to_string(a));
+			}
+			cont.sched[state] = 0;
+		}
+		return cont;
+	}
+
+	std::size_t count_differences(const scheduler_container::scheduler& a, const scheduler_container::scheduler& b) {
+		std::size_t count{ 0 };
+		for (const auto& [state, action] : a) {
+			count += b.at(state) != action;
+		}
+		return count;
+	}
+
+	/* index of the current scheduler in the order of operator++ */
+	big_int_type odometer_index(const scheduler_container& cont) {
+		big_int_type index{ 0 };
+		big_int_type weight{ 1 };
+		for (const auto& [state, action] : cont.sched) {
+			index += weight * action;
+			weight *= cont.available_actions_per_state.at(state).size();
+		}
+		return index;
+	}
+
+}
+
+TEST(gray_code_enumerator, consecutive_schedulers_differ_in_one_decision_from_every_start) {
+	for (const auto& radices : std::vector<std::vector<std::size_t>>{ { 2, 2, 2 }, { 3, 1, 2, 4 }, { 5 }, { 1, 1 } }) {
+		scheduler_container cont{ make_container(radices) };
+		const std::size_t count_schedulers{ cont.number_of_schedulers().numerator().convert_to<std::size_t>() };
+
+		for (std::size_t start{ 0 }; start < count_schedulers; ++start) {
+			scheduler_container current{ cont };
+			gray_code_enumerator gray(current, start);
+			std::set<big_int_type> visited{ odometer_index(current) };
+			for (std::size_t i{ start + 1 }; i < count_schedulers; ++i) {
+				const scheduler_container::scheduler previous{ current.sched };
+				const std::size_t changed{ gray.next() };
+				ASSERT_NE(changed, gray_code_enumerator::NONE);
+				EXPECT_EQ(count_differences(previous, current.sched), 1);
+				EXPECT_NE(previous.at(gray.state(changed)), current.sched.at(gray.state(changed)));
+				EXPECT_EQ(gray.decision(changed), current.sched.at(gray.state(changed)));
+				EXPECT_TRUE(visited.insert(odometer_index(current)).second) << "scheduler visited twice from start " << start;
+			}
+			EXPECT_EQ(gray.next(), gray_code_enumerator::NONE);
+			EXPECT_EQ(visited.size(), count_schedulers - start);
+		}
+	}
+}
+
+TEST(gray_code_enumerator, visits_every_index_once) {
+	scheduler_container cont{ make_container({ 3, 2, 4 }) };
+	const std::size_t count_schedulers{ cont.number_of_schedulers().numerator().convert_to<std::size_t>() };
+
+	gray_code_enumerator gray(cont, 0);
+	std::set<big_int_type> visited{ odometer_index(cont) };
+	while (gray.next() != gray_code_enumerator::NONE) {
+		EXPECT_TRUE(visited.insert(odometer_index(cont)).second);
+	}
+	ASSERT_EQ(visited.size(), count_schedulers);
+	EXPECT_EQ(*visited.begin(), 0);
+	EXPECT_EQ(*visited.rbegin(), count_schedulers - 1);
+}
+
+TEST(gray_code_enumerator, chunks_continue_each_other) {
+	scheduler_container cont{ make_container({ 3, 2, 2 }) };
+	const std::size_t count_schedulers{ cont.number_of_schedulers().numerator().convert_to<std::size_t>() };
+
+	std::vector<scheduler_container::scheduler> sequence;
+	scheduler_container whole{ cont };
+	gray_code_enumerator gray(whole, 0);
+	do {
+		sequence.push_back(whole.sched);
+	} while (gray.next() != gray_code_enumerator::NONE);
+
+	for (std::size_t start{ 0 }; start < count_schedulers; ++start) {
+		scheduler_container current{ cont };
+		gray_code_enumerator chunk(current, start);
+		EXPECT_EQ(current.sched, sequence[start]);
+	}
+}
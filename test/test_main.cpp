@@ -1,7 +1,13 @@
 #include "gtest/gtest.h"
 
+#include "../src/logger.h"
+
+#include "spdlog/spdlog.h"
+
 int main(int argc, char** argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
+    init_logger();
+    standard_logger()->set_level(spdlog::level::warn);
     return RUN_ALL_TESTS();
-}
\ No newline at end of file
+}